@@ -0,0 +1,285 @@
+#include "canvas.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 펜 색 번호 -> XRGB8888 (0은 지우개 = 배경색)
+static const uint32_t kPalette[10] = {
+    CANVAS_BACKGROUND, 0x00000000, 0x00E53935, 0x00FB8C00, 0x00FDD835,
+    0x0043A047, 0x001E88E5, 0x003949AB, 0x008E24AA, 0x006D4C41,
+};
+
+static uint32_t palette_color(int color) {
+    if (color < 0 || color >= (int)(sizeof(kPalette) / sizeof(kPalette[0]))) color = 1;
+    return kPalette[color];
+}
+
+// ---------------- SIMD 경로 ----------------
+// 가로 한 줄을 같은 색으로 채운다 (brush stamp의 기본 단위)
+static inline void fill_span(uint32_t* dst, int n, uint32_t c) {
+#if defined(__ARM_NEON)
+    uint32x4_t v = vdupq_n_u32(c);
+    for (; n >= 8; n -= 8, dst += 8) {
+        vst1q_u32(dst, v);
+        vst1q_u32(dst + 4, v);
+    }
+    for (; n >= 4; n -= 4, dst += 4) vst1q_u32(dst, v);
+#elif defined(__SSE2__)
+    __m128i v = _mm_set1_epi32((int)c);
+    for (; n >= 8; n -= 8, dst += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), v);
+    }
+    for (; n >= 4; n -= 4, dst += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+#endif
+    while (n-- > 0) *dst++ = c;
+}
+
+// XRGB8888 -> RGB565 (16bpp framebuffer)
+static inline void convert_565(uint16_t* dst, const uint32_t* src, int n) {
+#if defined(__ARM_NEON)
+    const uint32x4_t mr = vdupq_n_u32(0xF800), mg = vdupq_n_u32(0x07E0), mb = vdupq_n_u32(0x001F);
+    for (; n >= 4; n -= 4, dst += 4, src += 4) {
+        uint32x4_t p = vld1q_u32(src);
+        uint32x4_t v = vorrq_u32(vorrq_u32(vandq_u32(vshrq_n_u32(p, 8), mr), vandq_u32(vshrq_n_u32(p, 5), mg)),
+                                 vandq_u32(vshrq_n_u32(p, 3), mb));
+        vst1_u16(dst, vmovn_u32(v));
+    }
+#elif defined(__SSE2__)
+    const __m128i mr = _mm_set1_epi32(0xF800), mg = _mm_set1_epi32(0x07E0), mb = _mm_set1_epi32(0x001F);
+    const __m128i bias32 = _mm_set1_epi32(0x8000), bias16 = _mm_set1_epi16((short)0x8000);
+    for (; n >= 8; n -= 8, dst += 8, src += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4));
+        lo = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(lo, 8), mr), _mm_and_si128(_mm_srli_epi32(lo, 5), mg)),
+                          _mm_and_si128(_mm_srli_epi32(lo, 3), mb));
+        hi = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(hi, 8), mr), _mm_and_si128(_mm_srli_epi32(hi, 5), mg)),
+                          _mm_and_si128(_mm_srli_epi32(hi, 3), mb));
+        // SSE2에는 unsigned pack이 없으므로 부호 있는 범위로 옮겨 pack한 뒤 되돌린다
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_add_epi16(packed, bias16));
+    }
+#endif
+    for (; n > 0; --n) {
+        uint32_t p = *src++;
+        *dst++ = (uint16_t)(((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F));
+    }
+}
+
+const char* Canvas::simd_path() {
+#if defined(__ARM_NEON)
+    return "NEON";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+// ---------------- Framebuffer ----------------
+Framebuffer::~Framebuffer() {
+    if (mem) munmap(mem, size);
+    if (fd_ >= 0) close(fd_);
+}
+
+bool Framebuffer::open(const std::string& spec) {
+    if (spec.compare(0, 3, "fb:") == 0) {
+        std::string path = spec.substr(3);
+        fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd_ < 0) { perror(path.c_str()); return false; }
+        fb_var_screeninfo var;
+        fb_fix_screeninfo fix;
+        if (ioctl(fd_, FBIOGET_VSCREENINFO, &var) < 0 || ioctl(fd_, FBIOGET_FSCREENINFO, &fix) < 0) {
+            perror("FBIOGET_SCREENINFO");
+            return false;
+        }
+        if (var.bits_per_pixel != 32 && var.bits_per_pixel != 16) {
+            std::cerr << "[canvas] " << var.bits_per_pixel << "bpp framebuffer는 지원하지 않습니다\n";
+            return false;
+        }
+        width = var.xres;
+        height = var.yres;
+        bpp = var.bits_per_pixel;
+        stride = fix.line_length;
+        size = fix.smem_len;
+    } else if (spec.compare(0, 5, "file:") == 0) {
+        // 보드 없이 확인할 때: 800x480 XRGB8888 raw 파일
+        std::string path = spec.substr(5);
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) { perror(path.c_str()); return false; }
+        width = CANVAS_WIDTH;
+        height = CANVAS_HEIGHT;
+        bpp = 32;
+        stride = CANVAS_WIDTH * 4;
+        size = (size_t)stride * height;
+        if (ftruncate(fd_, size) < 0) { perror("ftruncate"); return false; }
+    } else {
+        std::cerr << "[canvas] unknown canvas: " << spec << " (fb:/dev/fb0 | file:PATH)\n";
+        return false;
+    }
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) { perror("mmap(framebuffer)"); return false; }
+    mem = static_cast<uint8_t*>(p);
+    return true;
+}
+
+// ---------------- Canvas ----------------
+Canvas::Canvas() : pixels_((size_t)CANVAS_WIDTH * CANVAS_HEIGHT, CANVAS_BACKGROUND) {
+    for (int r = 0; r <= CANVAS_MAX_BRUSH; ++r)
+        for (int dy = 0; dy <= CANVAS_MAX_BRUSH; ++dy) {
+            double h = (r + 0.5) * (r + 0.5) - (double)dy * dy;
+            span_[r][dy] = dy <= r && h > 0 ? (uint8_t)std::sqrt(h) : 0;
+        }
+}
+
+bool Canvas::attach(const std::string& spec) {
+    if (!fb_.open(spec)) return false;
+    std::cout << "[canvas] " << fb_.width << "x" << fb_.height << " " << fb_.bpp << "bpp (" << simd_path() << ")\n";
+    add_dirty({0, 0, CANVAS_WIDTH, CANVAS_HEIGHT});
+    present();
+    return true;
+}
+
+void Canvas::clear() {
+    fill_span(pixels_.data(), (int)pixels_.size(), CANVAS_BACKGROUND);
+    live_.has_last = false;
+    dirty_.clear();
+    add_dirty({0, 0, CANVAS_WIDTH, CANVAS_HEIGHT});
+}
+
+// 반지름 r 원 하나를 찍는다 (행마다 span 채우기)
+void Canvas::stamp(int cx, int cy, int r, uint32_t color) {
+    int y0 = std::max(cy - r, 0), y1 = std::min(cy + r, CANVAS_HEIGHT - 1);
+    for (int y = y0; y <= y1; ++y) {
+        int half = span_[r][std::abs(y - cy)];
+        int x0 = std::max(cx - half, 0), x1 = std::min(cx + half, CANVAS_WIDTH - 1);
+        if (x0 <= x1) fill_span(&pixels_[(size_t)y * CANVAS_WIDTH + x0], x1 - x0 + 1, color);
+    }
+}
+
+// 같은 획의 앞 점과 선분으로 이어 반지름의 절반 간격으로 stamp
+void Canvas::draw_point(const DrawPoint& p, StrokeTrack& track) {
+    int r = std::min(std::max(p.thick, 1), CANVAS_MAX_BRUSH);
+    uint32_t color = palette_color(p.color);
+    bool connect = track.has_last && p.drawStatus != DRAW_STROKE_START;
+    int ax = connect ? track.last.x : p.x, ay = connect ? track.last.y : p.y;
+
+    float dx = p.x - ax, dy = p.y - ay;
+    float spacing = std::max(1.0f, r * 0.5f);
+    int steps = std::max(1, (int)std::ceil(std::sqrt(dx * dx + dy * dy) / spacing));
+    for (int i = connect ? 1 : 0; i <= steps; ++i)
+        stamp(ax + (int)std::lround(dx * i / steps), ay + (int)std::lround(dy * i / steps), r, color);
+
+    add_dirty({std::min(ax, p.x) - r, std::min(ay, p.y) - r, std::max(ax, p.x) + r + 1, std::max(ay, p.y) + r + 1});
+    track.has_last = p.drawStatus != DRAW_STROKE_END;
+    track.last = p;
+    points_++;
+}
+
+void Canvas::add_dirty(DirtyRect r) {
+    r.x0 = std::max(r.x0, 0);
+    r.y0 = std::max(r.y0, 0);
+    r.x1 = std::min(r.x1, CANVAS_WIDTH);
+    r.y1 = std::min(r.y1, CANVAS_HEIGHT);
+    if (r.x0 >= r.x1 || r.y0 >= r.y1) return;
+
+    for (DirtyRect& d : dirty_) {
+        DirtyRect u{std::min(d.x0, r.x0), std::min(d.y0, r.y0), std::max(d.x1, r.x1), std::max(d.y1, r.y1)};
+        if (u.area() <= d.area() + r.area() + CANVAS_MERGE_SLACK) {
+            d = u;
+            return;
+        }
+    }
+    if (dirty_.size() < CANVAS_MAX_DIRTY) {
+        dirty_.push_back(r);
+        return;
+    }
+    for (const DirtyRect& d : dirty_) {
+        r.x0 = std::min(r.x0, d.x0);
+        r.y0 = std::min(r.y0, d.y0);
+        r.x1 = std::max(r.x1, d.x1);
+        r.y1 = std::max(r.y1, d.y1);
+    }
+    dirty_.assign(1, r);
+}
+
+size_t Canvas::present() {
+    size_t copied = 0;
+    if (fb_.mem != nullptr) {
+        for (const DirtyRect& d : dirty_) {
+            int x1 = std::min(d.x1, fb_.width), y1 = std::min(d.y1, fb_.height);
+            if (d.x0 >= x1 || d.y0 >= y1) continue;
+            int w = x1 - d.x0;
+            for (int y = d.y0; y < y1; ++y) {
+                const uint32_t* src = &pixels_[(size_t)y * CANVAS_WIDTH + d.x0];
+                uint8_t* row = fb_.mem + (size_t)y * fb_.stride;
+                if (fb_.bpp == 32)
+                    std::memcpy(row + d.x0 * 4, src, w * 4);
+                else
+                    convert_565(reinterpret_cast<uint16_t*>(row) + d.x0, src, w);
+            }
+            copied += (size_t)w * (y1 - d.y0);
+        }
+    }
+    dirty_.clear();
+    points_ = 0;
+    return copied;
+}
+
+// ---------------- benchmark ----------------
+void run_render_bench(const std::string& spec, int points_per_frame, int frames) {
+    Canvas canvas;
+    if (!canvas.attach(spec)) return;
+    if (points_per_frame < 1) points_per_frame = 1;
+    if (frames < 1) frames = 1;
+
+    // 합성 획: lissajous 곡선, 200점마다 새 획 (색/굵기 변경)
+    const int stroke_len = 200;
+    std::vector<double> frame_ms;
+    frame_ms.reserve(frames);
+    size_t total_copied = 0, total_dirty = 0;
+    uint64_t n = 0;
+    auto bench_start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < points_per_frame; ++i, ++n) {
+            double t = n * 0.004;
+            int k = n % stroke_len;
+            int stroke = n / stroke_len;
+            DrawPoint p{};
+            p.x = (int)(CANVAS_WIDTH / 2 + (CANVAS_WIDTH / 2 - 20) * std::sin(1.3 * t + stroke));
+            p.y = (int)(CANVAS_HEIGHT / 2 + (CANVAS_HEIGHT / 2 - 20) * std::sin(2.1 * t));
+            p.color = 1 + stroke % 9;
+            p.thick = 1 + stroke % 10;
+            p.drawStatus = k == 0 ? DRAW_STROKE_START : k == stroke_len - 1 ? DRAW_STROKE_END : DRAW_STROKE_CONTINUE;
+            canvas.draw_point(p);
+        }
+        total_dirty += canvas.dirty_count();
+        total_copied += canvas.present();
+        frame_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    }
+    double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - bench_start).count();
+
+    std::sort(frame_ms.begin(), frame_ms.end());
+    double p50 = frame_ms[frame_ms.size() / 2];
+    double p99 = frame_ms[std::min(frame_ms.size() - 1, frame_ms.size() * 99 / 100)];
+    std::cout << "[render-bench] " << frames << " frames x " << points_per_frame << " points/frame ("
+              << Canvas::simd_path() << ")\n";
+    std::cout << "[render-bench] " << (uint64_t)(frames / total_s) << " fps, "
+              << (uint64_t)(n / total_s) << " points/s, frame p50 " << p50 << " ms, p99 " << p99 << " ms\n";
+    std::cout << "[render-bench] dirty rects/frame " << (double)total_dirty / frames
+              << ", pixels copied/frame " << total_copied / frames
+              << " (full frame " << CANVAS_WIDTH * CANVAS_HEIGHT << ")\n";
+}
@@ -0,0 +1,76 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../Common/protocol.h"
+
+#define CANVAS_MAX_BRUSH 32        // 네트워크로 받은 thick은 이 반지름으로 제한
+#define CANVAS_MAX_DIRTY 16        // 넘으면 전체를 감싸는 사각형 하나로 합친다
+#define CANVAS_MERGE_SLACK (32 * 32)   // 합쳐서 늘어나는 면적이 이 이하면 합친다
+#define CANVAS_BACKGROUND 0x00FFFFFFu
+
+struct DirtyRect {
+    int x0, y0, x1, y1;   // [x0, x1) x [y0, y1)
+    int area() const { return (x1 - x0) * (y1 - y0); }
+};
+
+// mmap한 출력 화면. "fb:/dev/fb0" (16/32bpp) 또는 "file:PATH" (CANVAS 크기 XRGB8888 raw)
+class Framebuffer {
+public:
+    ~Framebuffer();
+    bool open(const std::string& spec);
+
+    uint8_t* mem = nullptr;
+    size_t size = 0;
+    int width = 0, height = 0;
+    int bpp = 0;
+    int stride = 0;   // 한 줄 byte 수
+
+private:
+    int fd_ = -1;
+};
+
+// 획 하나의 이어 그리기 상태 (실시간 재생과 TCP 보정 점은 서로 다른 track으로 그린다)
+struct StrokeTrack {
+    bool has_last = false;
+    DrawPoint last{};
+};
+
+// 받은 획을 XRGB8888 back buffer에 brush stamping으로 그리고,
+// 프레임마다 바뀐 사각형만 framebuffer에 복사한다
+class Canvas {
+public:
+    Canvas();
+    bool attach(const std::string& spec);
+    bool attached() const { return fb_.mem != nullptr; }
+
+    void draw_point(const DrawPoint& p, StrokeTrack& track);
+    void draw_point(const DrawPoint& p) { draw_point(p, live_); }
+    void clear();
+
+    // 쌓인 dirty 사각형을 framebuffer에 반영. 복사한 pixel 수
+    size_t present();
+
+    size_t points_since_present() const { return points_; }
+    size_t dirty_count() const { return dirty_.size(); }
+    static const char* simd_path();
+
+private:
+    void stamp(int cx, int cy, int r, uint32_t color);
+    void add_dirty(DirtyRect r);
+
+    std::vector<uint32_t> pixels_;   // CANVAS_WIDTH x CANVAS_HEIGHT
+    std::vector<DirtyRect> dirty_;
+    Framebuffer fb_;
+    StrokeTrack live_;
+    size_t points_ = 0;
+    uint8_t span_[CANVAS_MAX_BRUSH + 1][CANVAS_MAX_BRUSH + 1];   // 반지름 r, 행 dy의 반폭
+};
+
+// client_app render-bench: 서버 없이 합성 획으로 fps / 프레임당 점 수 측정
+void run_render_bench(const std::string& spec, int points_per_frame, int frames);
+
+#endif // CANVAS_H
@@ -4,6 +4,24 @@
 #include <string>
 #include "../Common/protocol.h"
 
-void run_client(const std::string& mode, const std::string& arg);
+struct ClientOptions {
+    std::string server_ip = SERVER_IP;
+    unsigned short server_port = SERVER_PORT;
+    int max_player = 2;
+    std::string dev_path;   // 비어 있으면 MYDEV_PATH 환경변수 또는 /dev/mydev
+    std::string input_source = "synthetic";
+    int sample_rate = 120;  // 입력 샘플링 (Hz)
+    int frame_rate = 60;    // 배치 전송/재생 주기 (fps)
+    int playout_ms = 50;    // 수신측 지터 버퍼 지연
+    int room_id = -1;       // >=0 이면 gateway에 MSG_JOIN_ROOM 전송
+    bool udp = false;       // 실시간 획 점을 UDP 보조 채널로
+    double udp_loss = 0.0;  // UDP 송신 손실 시뮬레이션 확률
+    double udp_reorder = 0.0;
+    std::string canvas;     // "fb:/dev/fb0" 또는 "file:PATH", 비어 있으면 콘솔 출력만
+    int bench_points = 32;  // render-bench: 프레임당 점 수
+    int bench_frames = 600;
+};
 
-#endif // CLIENT_H
\ No newline at end of file
+void run_client(const std::string& mode, const std::string& arg, const ClientOptions& opts);
+
+#endif // CLIENT_H
@@ -0,0 +1,132 @@
+#include "input.h"
+#include "../Common/protocol.h"
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+uint64_t monotonic_us() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// ---------------- synthetic ----------------
+#define SYNTH_STROKE_US 2000000ULL
+#define SYNTH_GAP_US 500000ULL
+
+bool SyntheticSource::sample(uint64_t now_us, InputSample& out) {
+    if (start_us_ == 0) start_us_ = now_us;
+    uint64_t elapsed = now_us - start_us_;
+    uint64_t phase = elapsed % (SYNTH_STROKE_US + SYNTH_GAP_US);
+    double t = elapsed / 1e6;
+    out.x = (int)(CANVAS_WIDTH / 2 + (CANVAS_WIDTH / 3) * std::sin(1.3 * t));
+    out.y = (int)(CANVAS_HEIGHT / 2 + (CANVAS_HEIGHT / 3) * std::sin(2.1 * t));
+    out.pen_down = phase < SYNTH_STROKE_US;
+    out.t_us = now_us;
+    return true;
+}
+
+// ---------------- trace ----------------
+bool TraceSource::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) { perror(path.c_str()); return false; }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        Point p{};
+        int down = 0;
+        if (!(ls >> p.t_ms >> p.x >> p.y >> down)) continue;
+        p.down = down != 0;
+        points_.push_back(p);
+    }
+    if (points_.empty()) {
+        std::cerr << "[input] empty trace: " << path << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool TraceSource::sample(uint64_t now_us, InputSample& out) {
+    if (start_us_ == 0) start_us_ = now_us;
+    uint64_t total_ms = points_.back().t_ms + 1;
+    uint64_t t_ms = ((now_us - start_us_) / 1000) % total_ms;   // 끝나면 반복 재생
+    if (cursor_ >= points_.size() || points_[cursor_].t_ms > t_ms) cursor_ = 0;
+    while (cursor_ + 1 < points_.size() && points_[cursor_ + 1].t_ms <= t_ms) cursor_++;
+    const Point& p = points_[cursor_];
+    out.x = p.x;
+    out.y = p.y;
+    out.pen_down = p.down;
+    out.t_us = now_us;
+    return true;
+}
+
+// ---------------- evdev device ----------------
+DeviceSource::~DeviceSource() {
+    if (fd_ >= 0) close(fd_);
+}
+
+static void read_absinfo(int fd, int code, int& lo, int& hi) {
+    input_absinfo info{};
+    if (ioctl(fd, EVIOCGABS(code), &info) == 0 && info.maximum > info.minimum) {
+        lo = info.minimum;
+        hi = info.maximum;
+    }
+}
+
+bool DeviceSource::open_device(const std::string& path) {
+    fd_ = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ < 0) { perror(path.c_str()); return false; }
+    min_x_ = 0; max_x_ = CANVAS_WIDTH - 1;
+    min_y_ = 0; max_y_ = CANVAS_HEIGHT - 1;
+    read_absinfo(fd_, ABS_X, min_x_, max_x_);
+    read_absinfo(fd_, ABS_Y, min_y_, max_y_);
+    return true;
+}
+
+void DeviceSource::on_readable() {
+    input_event ev[32];
+    ssize_t n;
+    while ((n = read(fd_, ev, sizeof(ev))) > 0) {
+        for (size_t i = 0; i < n / sizeof(input_event); ++i) {
+            if (ev[i].type == EV_ABS) {
+                if (ev[i].code == ABS_X || ev[i].code == ABS_MT_POSITION_X) raw_x_ = ev[i].value;
+                else if (ev[i].code == ABS_Y || ev[i].code == ABS_MT_POSITION_Y) raw_y_ = ev[i].value;
+            } else if (ev[i].type == EV_KEY && (ev[i].code == BTN_TOUCH || ev[i].code == BTN_LEFT)) {
+                down_ = ev[i].value != 0;
+            }
+        }
+    }
+}
+
+bool DeviceSource::sample(uint64_t now_us, InputSample& out) {
+    out.x = (int)((int64_t)(raw_x_ - min_x_) * (CANVAS_WIDTH - 1) / (max_x_ - min_x_));
+    out.y = (int)((int64_t)(raw_y_ - min_y_) * (CANVAS_HEIGHT - 1) / (max_y_ - min_y_));
+    out.pen_down = down_;
+    out.t_us = now_us;
+    return true;
+}
+
+std::unique_ptr<InputSource> make_input_source(const std::string& spec) {
+    if (spec.empty() || spec == "synthetic")
+        return std::make_unique<SyntheticSource>();
+    if (spec.compare(0, 6, "trace:") == 0) {
+        auto src = std::make_unique<TraceSource>();
+        if (!src->load(spec.substr(6))) return nullptr;
+        return src;
+    }
+    if (spec.compare(0, 7, "device:") == 0) {
+        auto src = std::make_unique<DeviceSource>();
+        if (!src->open_device(spec.substr(7))) return nullptr;
+        return src;
+    }
+    std::cerr << "[input] unknown source: " << spec << '\n';
+    return nullptr;
+}
@@ -0,0 +1,69 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define INPUT_MIN_RATE 60
+#define INPUT_MAX_RATE 240
+
+uint64_t monotonic_us();
+
+struct InputSample {
+    int x = 0;
+    int y = 0;
+    bool pen_down = false;
+    uint64_t t_us = 0;      // CLOCK_MONOTONIC, 샘플링 시점에 부여
+};
+
+// 샘플링 타이머가 호출할 때마다 현재 입력 상태를 돌려주는 소스
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+    virtual bool sample(uint64_t now_us, InputSample& out) = 0;
+    // 이벤트를 비동기로 받아야 하는 소스는 fd를 노출하고 readable일 때 on_readable()이 호출된다
+    virtual int fd() const { return -1; }
+    virtual void on_readable() {}
+};
+
+// 합성 입력: 2초 획 + 0.5초 pen-up 을 반복하는 리사주 곡선
+class SyntheticSource : public InputSource {
+public:
+    bool sample(uint64_t now_us, InputSample& out) override;
+private:
+    uint64_t start_us_ = 0;
+};
+
+// 기록된 궤적 재생. 한 줄에 "t_ms x y pen_down", '#'은 주석
+class TraceSource : public InputSource {
+public:
+    bool load(const std::string& path);
+    bool sample(uint64_t now_us, InputSample& out) override;
+private:
+    struct Point { uint64_t t_ms; int x; int y; bool down; };
+    std::vector<Point> points_;
+    size_t cursor_ = 0;
+    uint64_t start_us_ = 0;
+};
+
+// 로컬 evdev 장치 (/dev/input/eventN). 좌표는 캔버스 크기로 스케일
+class DeviceSource : public InputSource {
+public:
+    ~DeviceSource() override;
+    bool open_device(const std::string& path);
+    bool sample(uint64_t now_us, InputSample& out) override;
+    int fd() const override { return fd_; }
+    void on_readable() override;
+private:
+    int fd_ = -1;
+    int min_x_ = 0, max_x_ = 0, min_y_ = 0, max_y_ = 0;
+    int raw_x_ = 0, raw_y_ = 0;
+    bool down_ = false;
+};
+
+// "synthetic" | "trace:PATH" | "device:PATH"
+std::unique_ptr<InputSource> make_input_source(const std::string& spec);
+
+#endif // INPUT_H
@@ -1,13 +1,21 @@
 #include "client.h"
+#include "reactor.h"
+#include "input.h"
+#include "stroke_pipeline.h"
+#include "udp_channel.h"
+#include "canvas.h"
 #include "../../gpio/user/gpio_control.h"
 #include <iostream>
-#include <thread>
 #include <cstring>
+#include <cstdlib>
 #include <netinet/in.h>
+#include <sys/epoll.h>
 #include <unistd.h>
 #include <arpa/inet.h>
-#include <atomic>
 #include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 void send_string(int fd, const std::string& s) {
     uint32_t len = s.size();
@@ -31,95 +39,458 @@ void send_drawpacket(int fd, const DrawPacket& pkt) {
 bool recv_drawpacket(int fd, DrawPacket& pkt) {
     return recv(fd, &pkt, sizeof(pkt), MSG_WAITALL) == sizeof(pkt);
 }
+// header + 점들을 한 번의 send로 전송
+void send_drawbatch(int fd, const std::vector<DrawPoint>& points) {
+    char buf[sizeof(DrawBatchHeader) + MAX_DRAW_BATCH * sizeof(DrawPoint)];
+    DrawBatchHeader hdr{MSG_DRAW_BATCH, (int)points.size()};
+    std::memcpy(buf, &hdr, sizeof(hdr));
+    std::memcpy(buf + sizeof(hdr), points.data(), points.size() * sizeof(DrawPoint));
+    send(fd, buf, sizeof(hdr) + points.size() * sizeof(DrawPoint), 0);
+}
+bool recv_drawbatch(int fd, std::vector<DrawPoint>& points) {
+    DrawBatchHeader hdr;
+    if (recv(fd, &hdr, sizeof(hdr), MSG_WAITALL) != sizeof(hdr)) return false;
+    if (hdr.count < 0 || hdr.count > MAX_DRAW_BATCH) return false;
+    points.resize(hdr.count);
+    ssize_t len = hdr.count * sizeof(DrawPoint);
+    return len == 0 || recv(fd, points.data(), len, MSG_WAITALL) == len;
+}
 void send_answerpacket(int fd, const AnswerPacket& pkt) {
     send(fd, &pkt.type, sizeof(pkt.type), 0);
     send_string(fd, pkt.nickname);
     send_string(fd, pkt.answer);
 }
-void send_correctpacket(int fd, const CorrectPacket& pkt) {
-    send(fd, &pkt.type, sizeof(pkt.type), 0);
-    send_string(fd, pkt.nickname);
-}
-bool recv_correctpacket(int fd, CorrectPacket& pkt) {
-    int header;
-    if (recv(fd, &header, sizeof(header), MSG_WAITALL) != sizeof(header)) return false;
-    pkt.type = header;
-    pkt.nickname = recv_string(fd);
+// 서버는 정답/오답을 CommonPacket(type, player_id, message)으로 브로드캐스트한다
+bool recv_commonpacket(int fd, CommonPacket& pkt) {
+    int header[2];
+    if (recv(fd, header, sizeof(header), MSG_WAITALL) != sizeof(header)) return false;
+    pkt.type = header[0];
+    pkt.player_id = header[1];
+    pkt.message = recv_string(fd);
     return true;
 }
-void send_wrongpacket(int fd, const WrongPacket& pkt) {
-    send(fd, &pkt.type, sizeof(pkt.type), 0);
-    send_string(fd, pkt.message);
+bool recv_selectedplayerpacket(int fd, SelectedPlayerPacket& pkt) {
+    return recv(fd, &pkt, sizeof(pkt), MSG_WAITALL) == sizeof(pkt);
 }
-bool recv_wrongpacket(int fd, WrongPacket& pkt) {
-    int header;
-    if (recv(fd, &header, sizeof(header), MSG_WAITALL) != sizeof(header)) return false;
-    pkt.type = header;
-    pkt.message = recv_string(fd);
+bool recv_strokesegment(int fd, StrokeSegment& seg) {
+    if (recv(fd, &seg.hdr, sizeof(seg.hdr), MSG_WAITALL) != sizeof(seg.hdr)) return false;
+    if (seg.hdr.count < 0 || seg.hdr.count > MAX_STROKE_SEGMENT) return false;
+    ssize_t len = seg.hdr.count * sizeof(DrawPoint);
+    return len == 0 || recv(fd, seg.points, len, MSG_WAITALL) == len;
+}
+bool recv_playertable(int fd, std::unordered_map<int, std::string>& players) {
+    PlayerTableHeader hdr;
+    if (recv(fd, &hdr, sizeof(hdr), MSG_WAITALL) != sizeof(hdr)) return false;
+    players.clear();
+    for (int i = 0; i < hdr.count; ++i) {
+        int player_id;
+        if (recv(fd, &player_id, sizeof(player_id), MSG_WAITALL) != sizeof(player_id)) return false;
+        players[player_id] = recv_string(fd);
+    }
+    return true;
+}
+bool recv_playerjoin(int fd, std::unordered_map<int, std::string>& players, int& player_id) {
+    int header[2];
+    if (recv(fd, header, sizeof(header), MSG_WAITALL) != sizeof(header)) return false;
+    player_id = header[1];
+    players[player_id] = recv_string(fd);
     return true;
 }
 
-std::atomic<bool> stop_draw{false};
+#define PEN_MIN_THICK 1
+#define PEN_MAX_THICK 10
+#define PEN_COLOR_CNT 10
+#define PEN_ERASER_COLOR 0
+#define LED_CORRECT_MS 2000
+#define LED_BLINK_MS 100       // 오답: 드라이버 LED_BLINK와 같은 주기로
+#define LED_BLINK_TOGGLES 8    // on/off 4번
 
-void recv_thread(int sockfd) {
-    while (true) {
-        int msg_type = 0;
-        ssize_t n = recv(sockfd, &msg_type, sizeof(int), MSG_PEEK);
-        if (n <= 0) break;
+struct PenState {
+    int color = 1;
+    int thick = 1;
+    bool eraser = false;
+};
 
-        if (msg_type == MSG_DRAW) {
-            DrawPacket pkt;
-            if (!recv_drawpacket(sockfd, pkt)) break;
-            std::cout << "[DRAW] (" << pkt.x << ", " << pkt.y << ") color:" << pkt.color << " thick:" << pkt.thick << '\n';
-        } else if (msg_type == MSG_CORRECT) {
-            CorrectPacket pkt;
-            if (!recv_correctpacket(sockfd, pkt)) break;
-            std::cout << "[정답!] " << pkt.nickname << "님이 정답을 맞혔습니다!\n";
-            gpio_led_correct();
-            stop_draw = true;
-        } else if (msg_type == MSG_WRONG) {
-            WrongPacket pkt;
-            if (!recv_wrongpacket(sockfd, pkt)) break;
-            std::cout << "[오답] " << pkt.message << std::endl;
-            gpio_led_wrong();
+struct ClientContext {
+    explicit ClientContext(const ClientOptions& opts) : opts(opts), jitter(opts.playout_ms * 1000) {}
+
+    const ClientOptions& opts;
+    Reactor reactor;
+    int sockfd = -1;
+    int devfd = -1;
+    int led_timer = -1;
+    int led_blink_timer = -1;
+    int led_blink_left = 0;
+    PenState pen;
+    bool drawing = false;
+    bool finished = false;   // 정답 처리 완료 후 LED off까지 기다렸다가 종료
+
+    std::unique_ptr<InputSource> source;
+    StrokeBatcher batcher;
+    JitterBuffer jitter;
+    std::vector<DrawPoint> rx_points;
+    std::vector<DrawPoint> render_points;
+    std::unordered_map<int, std::string> players;  // player_id -> nickname
+
+    // UDP 획 채널 (서버가 MSG_UDP_OFFER로 응답한 뒤에만 활성화)
+    UdpStrokeChannel udp;
+    bool udp_active = false;
+    StrokeSequencer sequencer;
+    StrokeLog stroke_log;
+    StrokeSegment rx_segment;
+    uint64_t last_sync_us = 0;
+    std::vector<DrawPoint> live_points;
+    std::vector<RepairedPoint> repair_points;
+
+    // --canvas: 받은 획을 framebuffer에 그린다 (프레임마다 dirty 사각형만 반영)
+    Canvas canvas;
+};
+
+static std::string player_name(const ClientContext& ctx, int player_id) {
+    auto it = ctx.players.find(player_id);
+    if (it != ctx.players.end()) return it->second;
+    return "player" + std::to_string(player_id);
+}
+
+static void finish(ClientContext& ctx) {
+    ctx.finished = true;
+    ctx.drawing = false;
+    // LED가 켜져 있으면 타이머가 끄고 루프를 멈춘다
+    if (ctx.devfd < 0 || ctx.led_timer < 0) ctx.reactor.stop();
+}
+
+// 드라이버의 LED_BLINK ioctl은 커널에서 800ms 동안 mdelay하므로 루프를 멈춘다.
+// 대신 타이머로 LED_ON/LED_OFF를 번갈아 보낸다
+static void start_wrong_blink(ClientContext& ctx) {
+    if (ctx.devfd < 0 || ctx.led_blink_timer < 0 || ctx.finished) return;
+    gpio_device_request(ctx.devfd, LED_ON);
+    ctx.led_blink_left = LED_BLINK_TOGGLES - 1;
+    ctx.reactor.arm_timer(ctx.led_blink_timer, std::chrono::milliseconds(LED_BLINK_MS),
+                          std::chrono::milliseconds(LED_BLINK_MS));
+}
+
+static void on_blink_tick(ClientContext& ctx) {
+    if (ctx.led_blink_left <= 0) {
+        ctx.reactor.disarm_timer(ctx.led_blink_timer);
+        return;
+    }
+    ctx.led_blink_left--;
+    gpio_device_request(ctx.devfd, ctx.led_blink_left % 2 ? LED_ON : LED_OFF);
+    if (ctx.led_blink_left == 0) ctx.reactor.disarm_timer(ctx.led_blink_timer);
+}
+
+// 받은 획/보정 대기 중인 점을 모두 버리고 화면을 지운다
+static void clear_canvas_state(ClientContext& ctx) {
+    ctx.jitter.clear();
+    ctx.stroke_log.clear();
+    ctx.repair_points.clear();
+    ctx.canvas.clear();
+}
+
+static void send_clear(ClientContext& ctx) {
+    DrawPacket pkt{};
+    pkt.type = MSG_CLEAR;
+    ctx.batcher.clear();
+    send_drawpacket(ctx.sockfd, pkt);
+    // 서버는 CLEAR를 보낸 쪽에 되돌려 주지 않으므로 자기 화면은 직접 지운다
+    clear_canvas_state(ctx);
+    std::cout << "[CLEAR 전송]\n";
+}
+
+static void on_button(ClientContext& ctx, int btn_idx) {
+    PenState& pen = ctx.pen;
+    switch (btn_idx) {
+        case BTN_EVT_CLEAR_PEN:
+            pen.eraser = !pen.eraser;
+            break;
+        case BTN_EVT_CLEAR:
+            send_clear(ctx);
+            gpio_device_request(ctx.devfd, BTN_CLEAR);
+            break;
+        case BTN_EVT_COLOR_CHANGE:
+            pen.eraser = false;
+            pen.color = pen.color % (PEN_COLOR_CNT - 1) + 1; // 0은 지우개 색
+            break;
+        case BTN_EVT_INC_PEN_SIZE:
+            if (pen.thick < PEN_MAX_THICK) pen.thick++;
+            break;
+        case BTN_EVT_DEC_PEN_SIZE:
+            if (pen.thick > PEN_MIN_THICK) pen.thick--;
+            break;
+        default:
+            std::cerr << "[button] unknown index " << btn_idx << '\n';
+            return;
+    }
+    std::cout << "[button " << btn_idx << "] color:" << pen.color << " thick:" << pen.thick
+              << (pen.eraser ? " (eraser)" : "") << '\n';
+}
+
+// UDP/TCP로 받은 획 segment. UDP는 최신보다 오래된 점을 버리고, TCP(sync)는 빈칸을 채운다
+static void on_stroke_segment(ClientContext& ctx, const StrokeSegment& seg, bool via_udp) {
+    ctx.live_points.clear();
+    ctx.stroke_log.accept(seg, via_udp, ctx.live_points, ctx.repair_points);
+    uint64_t now = monotonic_us();
+    for (const DrawPoint& p : ctx.live_points) ctx.jitter.push(p, now);
+}
+
+static void start_udp(ClientContext& ctx, const UdpOfferPacket& offer) {
+    if (ctx.udp_active) return;
+    LossSim sim(ctx.opts.udp_loss, 0.0, ctx.opts.udp_reorder, offer.token);
+    if (!ctx.udp.open(ctx.opts.server_ip, offer.udp_port, offer.token, sim)) return;
+    ctx.udp_active = true;
+    ctx.udp.send_hello();
+    ctx.reactor.add(ctx.udp.fd(), EPOLLIN, [&ctx](uint32_t) {
+        while (ctx.udp.recv_segment(ctx.rx_segment)) on_stroke_segment(ctx, ctx.rx_segment, true);
+    });
+    // 주소 등록 + NAT 유지용 hello
+    ctx.reactor.add_timer(std::chrono::milliseconds(UDP_HELLO_INTERVAL_MS),
+                          std::chrono::milliseconds(UDP_HELLO_INTERVAL_MS),
+                          [&ctx](uint64_t) { ctx.udp.send_hello(); });
+    std::cout << "[udp] 획 채널 사용 (port " << offer.udp_port << ")\n";
+}
+
+// 소켓이 readable일 때 메시지 하나를 처리. 연결이 끊기면 false
+static bool on_socket_readable(ClientContext& ctx) {
+    int sockfd = ctx.sockfd;
+    int msg_type = 0;
+    ssize_t n = recv(sockfd, &msg_type, sizeof(int), MSG_PEEK);
+    if (n <= 0) return false;
+
+    if (msg_type == MSG_DRAW || msg_type == MSG_CLEAR) {
+        DrawPacket pkt;
+        if (!recv_drawpacket(sockfd, pkt)) return false;
+        if (msg_type == MSG_CLEAR) {
+            clear_canvas_state(ctx);
+            std::cout << "[CLEAR]\n";
+        } else if (ctx.canvas.attached()) {
+            DrawPoint p{};
+            p.x = pkt.x;
+            p.y = pkt.y;
+            p.color = pkt.color;
+            p.thick = pkt.thick;
+            p.drawStatus = DRAW_STROKE_START;
+            ctx.canvas.draw_point(p);
         } else {
-            char buf[256];
-            recv(sockfd, buf, sizeof(buf), 0);
+            std::cout << "[DRAW] (" << pkt.x << ", " << pkt.y << ") color:" << pkt.color << " thick:" << pkt.thick << '\n';
+        }
+    } else if (msg_type == MSG_DRAW_BATCH) {
+        if (!recv_drawbatch(sockfd, ctx.rx_points)) return false;
+        uint64_t now = monotonic_us();
+        for (const DrawPoint& p : ctx.rx_points) ctx.jitter.push(p, now);
+    } else if (msg_type == MSG_STROKE_SEGMENT) {
+        if (!recv_strokesegment(sockfd, ctx.rx_segment)) return false;
+        on_stroke_segment(ctx, ctx.rx_segment, false);
+    } else if (msg_type == MSG_UDP_OFFER) {
+        UdpOfferPacket pkt;
+        if (recv(sockfd, &pkt, sizeof(pkt), MSG_WAITALL) != sizeof(pkt)) return false;
+        start_udp(ctx, pkt);
+    } else if (msg_type == MSG_CORRECT) {
+        CommonPacket pkt;
+        if (!recv_commonpacket(sockfd, pkt)) return false;
+        std::cout << "[정답!] " << player_name(ctx, pkt.player_id) << "님이 정답을 맞혔습니다! (" << pkt.message << ")\n";
+        if (ctx.devfd >= 0 && ctx.led_timer >= 0) {
+            ctx.reactor.disarm_timer(ctx.led_blink_timer);
+            gpio_device_request(ctx.devfd, LED_ON);
+            ctx.reactor.arm_timer(ctx.led_timer, std::chrono::milliseconds(LED_CORRECT_MS),
+                                  std::chrono::nanoseconds(0));
         }
+        finish(ctx);
+    } else if (msg_type == MSG_WRONG) {
+        CommonPacket pkt;
+        if (!recv_commonpacket(sockfd, pkt)) return false;
+        std::cout << "[오답] " << player_name(ctx, pkt.player_id) << ": " << pkt.message << std::endl;
+        start_wrong_blink(ctx);
+    } else if (msg_type == MSG_ERROR) {
+        CommonPacket pkt;
+        if (!recv_commonpacket(sockfd, pkt)) return false;
+        std::cout << "[서버 오류] " << pkt.message << std::endl;
+    } else if (msg_type == MSG_PLAYER_NUM) {
+        PlayerNumPacket pkt;
+        if (recv(sockfd, &pkt, sizeof(pkt), MSG_WAITALL) != sizeof(pkt)) return false;
+        std::cout << "[입장] player" << pkt.player_num << '\n';
+    } else if (msg_type == MSG_PLAYER_CNT) {
+        PlayerCntPacket pkt;
+        if (recv(sockfd, &pkt, sizeof(pkt), MSG_WAITALL) != sizeof(pkt)) return false;
+        std::cout << "[인원] " << pkt.currentPlayer_cnt << "/" << pkt.maxPlayer << '\n';
+    } else if (msg_type == MSG_SELECTED_PLAYER) {
+        SelectedPlayerPacket pkt;
+        if (!recv_selectedplayerpacket(sockfd, pkt)) return false;
+        std::cout << "[출제자] " << player_name(ctx, pkt.player_id) << '\n';
+    } else if (msg_type == MSG_PLAYER_TABLE) {
+        if (!recv_playertable(sockfd, ctx.players)) return false;
+        std::cout << "[플레이어 목록] " << ctx.players.size() << "명\n";
+    } else if (msg_type == MSG_PLAYER_JOIN) {
+        int player_id;
+        if (!recv_playerjoin(sockfd, ctx.players, player_id)) return false;
+        std::cout << "[입장] " << player_name(ctx, player_id) << '\n';
+    } else if (msg_type == MSG_PLAYER_LEAVE) {
+        PlayerLeavePacket pkt;
+        if (recv(sockfd, &pkt, sizeof(pkt), MSG_WAITALL) != sizeof(pkt)) return false;
+        std::cout << "[퇴장] " << player_name(ctx, pkt.player_id) << '\n';
+        ctx.players.erase(pkt.player_id);
+    } else if (msg_type == MSG_REJECTED) {
+        int dummy;
+        recv(sockfd, &dummy, sizeof(dummy), 0);
+        std::cout << "[서버] 입장 거절\n";
+        return false;
+    } else {
+        char buf[256];
+        recv(sockfd, buf, sizeof(buf), 0);
+    }
+    return true;
+}
+
+static void send_sync_segment(ClientContext& ctx, StrokeSegment& seg) {
+    send(ctx.sockfd, &seg, seg.bytes(), 0);
+    ctx.last_sync_us = monotonic_us();
+}
+
+static void flush_batch(ClientContext& ctx) {
+    if (ctx.batcher.empty()) return;
+    if (ctx.udp_active) {
+        ctx.sequencer.add(ctx.batcher.points(),
+                          [&ctx](StrokeSegment& seg) { ctx.udp.send_segment(seg); },
+                          [&ctx](StrokeSegment& seg) { send_sync_segment(ctx, seg); });
+    } else {
+        send_drawbatch(ctx.sockfd, ctx.batcher.points());
     }
-    std::cout << "서버 연결 종료\n";
-    stop_draw = true;
+    ctx.batcher.clear();
 }
 
-void run_draw_loop(int sockfd) {
-    int x = 0, y = 0;
-    while (!stop_draw) {
-        DrawPacket pkt{};
-        pkt.type = MSG_DRAW;
-        pkt.x = x; pkt.y = y; pkt.color = (x+y)%10; pkt.thick = 1+(x%5);
-        send_drawpacket(sockfd, pkt);
-        std::cout << "[좌표전송] (" << pkt.x << ", " << pkt.y << ")\n";
-        x += 10; y += 7;
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+static void on_sample_tick(ClientContext& ctx) {
+    if (!ctx.drawing) return;
+    InputSample s;
+    if (!ctx.source->sample(monotonic_us(), s)) return;
+    int color = ctx.pen.eraser ? PEN_ERASER_COLOR : ctx.pen.color;
+    size_t before = ctx.batcher.points().size();
+    bool full = ctx.batcher.add(s, color, ctx.pen.thick);
+    // 그리는 쪽은 서버가 되돌려 주지 않으므로 자기 획을 직접 그린다
+    if (ctx.canvas.attached() && ctx.batcher.points().size() > before)
+        ctx.canvas.draw_point(ctx.batcher.points().back());
+    if (full) flush_batch(ctx);
+}
+
+static void on_frame_tick(ClientContext& ctx) {
+    uint64_t now = monotonic_us();
+    if (ctx.drawing) {
+        flush_batch(ctx);
+        if (ctx.udp_active && now - ctx.last_sync_us >= STROKE_SYNC_INTERVAL_MS * 1000ULL)
+            ctx.sequencer.flush_sync([&ctx](StrokeSegment& seg) { send_sync_segment(ctx, seg); });
+    }
+
+    if (!ctx.repair_points.empty()) {
+        // 보정 점마다 새 track: 서로 다른 빈칸/획/플레이어의 점끼리 잇지 않는다
+        for (const RepairedPoint& r : ctx.repair_points) {
+            if (!ctx.canvas.attached()) break;
+            StrokeTrack track;
+            if (r.has_prev) ctx.canvas.draw_point(r.prev, track);
+            ctx.canvas.draw_point(r.point, track);
+            if (r.has_next) ctx.canvas.draw_point(r.next, track);
+        }
+        std::cout << "[SYNC] " << ctx.repair_points.size() << " points repaired (stale dropped: "
+                  << ctx.stroke_log.stale_dropped << ", out of range: " << ctx.stroke_log.out_of_range << ")\n";
+        ctx.repair_points.clear();
     }
-    std::cout << "[draw] 정지됨\n";
+
+    ctx.render_points.clear();
+    ctx.jitter.render(now, ctx.render_points);
+    if (ctx.canvas.attached()) {
+        // 한 프레임에 받은 점을 모두 그린 뒤 framebuffer에는 한 번만 반영
+        for (const DrawPoint& p : ctx.render_points) ctx.canvas.draw_point(p);
+        ctx.canvas.present();
+        return;
+    }
+    if (ctx.render_points.empty()) return;
+    const DrawPoint& last = ctx.render_points.back();
+    std::cout << "[DRAW] " << ctx.render_points.size() << " points -> (" << last.x << ", " << last.y
+              << ") color:" << last.color << " thick:" << last.thick << '\n';
 }
 
-void run_client(const std::string& mode, const std::string& arg) {
-    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+void run_client(const std::string& mode, const std::string& arg, const ClientOptions& opts) {
+    if (mode == "render-bench") {
+        // 서버 없이 canvas 경로만 측정
+        run_render_bench(opts.canvas.empty() ? "file:/tmp/canvas.raw" : opts.canvas,
+                         opts.bench_points, opts.bench_frames);
+        return;
+    }
+    if (mode != "draw" && mode != "answer" && mode != "watch") {
+        std::cout << "Unknown mode: " << mode << std::endl;
+        return;
+    }
+
+    int sockfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (sockfd < 0) { perror("socket"); exit(1); }
     sockaddr_in serv_addr{};
     serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(SERVER_PORT);
-    serv_addr.sin_addr.s_addr = inet_addr(SERVER_IP);
+    serv_addr.sin_port = htons(opts.server_port);
+    serv_addr.sin_addr.s_addr = inet_addr(opts.server_ip.c_str());
     if (connect(sockfd, (sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
         perror("connect"); exit(1);
     }
 
-    std::thread(recv_thread, sockfd).detach();
+    if (opts.room_id >= 0) {
+        JoinRoomPacket room_pkt{MSG_JOIN_ROOM, opts.room_id};
+        send(sockfd, &room_pkt, sizeof(room_pkt), 0);
+    }
+    if (mode == "watch") {
+        // 관전자: 인원 제한 없이 읽기만 한다 (server_app 또는 relay_app 어느 쪽이든 접속 가능)
+        SpectatePacket spec_pkt{MSG_SPECTATE};
+        send(sockfd, &spec_pkt, sizeof(spec_pkt), 0);
+    } else {
+        // 서버는 모든 플레이어에게 MSG_SET_MAX_PLAYER + 값 1쌍을 요구한다
+        int join[2] = { MSG_SET_MAX_PLAYER, opts.max_player };
+        send(sockfd, join, sizeof(join), 0);
+    }
+    if (opts.udp && mode != "watch") {
+        UdpRequestPacket req{MSG_UDP_REQUEST};
+        send(sockfd, &req, sizeof(req), 0);
+    }
+
+    ClientContext ctx(opts);
+    ctx.sockfd = sockfd;
+    if (!opts.canvas.empty() && !ctx.canvas.attach(opts.canvas)) { close(sockfd); exit(1); }
+    ctx.devfd = gpio_open_device(opts.dev_path.empty() ? nullptr : opts.dev_path.c_str());
+    if (ctx.devfd < 0) std::cerr << "[client] 버튼 장치 없이 실행합니다\n";
+
+    ctx.reactor.add(sockfd, EPOLLIN | EPOLLRDHUP, [&ctx](uint32_t) {
+        if (!on_socket_readable(ctx)) {
+            std::cout << "서버 연결 종료\n";
+            ctx.reactor.stop();
+        }
+    });
+
+    if (ctx.devfd >= 0) {
+        ctx.reactor.add(ctx.devfd, EPOLLIN, [&ctx](uint32_t events) {
+            // EPOLLIN 한 번에 한 이벤트만: 실제 드라이버의 read는 O_NONBLOCK을 무시하고
+            // 다음 버튼이 눌릴 때까지 block한다 (남은 이벤트는 level-triggered로 다시 깨어난다)
+            int btn_idx;
+            if ((events & EPOLLIN) && gpio_read_button(ctx.devfd, btn_idx)) on_button(ctx, btn_idx);
+        });
+        ctx.led_timer = ctx.reactor.add_timer(std::chrono::nanoseconds(0), std::chrono::nanoseconds(0),
+                                              [&ctx](uint64_t) {
+            gpio_device_request(ctx.devfd, LED_OFF);
+            if (ctx.finished) ctx.reactor.stop();
+        });
+        ctx.led_blink_timer = ctx.reactor.add_timer(std::chrono::nanoseconds(0), std::chrono::nanoseconds(0),
+                                                    [&ctx](uint64_t) { on_blink_tick(ctx); });
+    }
+
+    // 송신: 프레임마다 배치 전송 / 수신: 프레임마다 지터 버퍼에서 재생
+    ctx.reactor.add_timer(std::chrono::nanoseconds(0), std::chrono::nanoseconds(1000000000LL / opts.frame_rate),
+                          [&ctx](uint64_t) { on_frame_tick(ctx); });
 
     if (mode == "draw") {
-        run_draw_loop(sockfd);
+        ctx.source = make_input_source(opts.input_source);
+        if (!ctx.source) { close(sockfd); exit(1); }
+        if (ctx.source->fd() >= 0) {
+            InputSource* src = ctx.source.get();
+            ctx.reactor.add(src->fd(), EPOLLIN, [src](uint32_t) { src->on_readable(); });
+        }
+        ctx.drawing = true;
+        ctx.reactor.add_timer(std::chrono::nanoseconds(0), std::chrono::nanoseconds(1000000000LL / opts.sample_rate),
+                              [&ctx](uint64_t) { on_sample_tick(ctx); });
+        std::cout << "[draw] " << opts.input_source << " @ " << opts.sample_rate << "Hz, batch "
+                  << opts.frame_rate << "fps\n";
     } else if (mode == "answer") {
         AnswerPacket apkt{};
         apkt.type = MSG_ANSWER;
@@ -127,21 +498,62 @@ void run_client(const std::string& mode, const std::string& arg) {
         apkt.answer = arg;
         send_answerpacket(sockfd, apkt);
         std::cout << "[정답전송] : " << arg << std::endl;
-        while (!stop_draw) std::this_thread::sleep_for(std::chrono::milliseconds(200));
-    } else {
-        std::cout << "Unknown mode: " << mode << std::endl;
     }
 
+    ctx.reactor.run();
+    if (mode == "draw") std::cout << "[draw] 정지됨\n";
+
+    if (ctx.devfd >= 0) close(ctx.devfd);
     close(sockfd);
 }
 
+static bool parse_option(const std::string& a, const char* key, std::string& value) {
+    std::string prefix = std::string("--") + key + "=";
+    if (a.compare(0, prefix.size(), prefix) != 0) return false;
+    value = a.substr(prefix.size());
+    return true;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "usage: " << argv[0] << " <mode:draw|answer> <answer_word>\n";
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <mode:draw|answer|watch|render-bench> <answer_word> [options]\n";
+        std::cerr << "  --server=IP --port=N --room=N(gateway) --max-player=N --dev=PATH\n";
+        std::cerr << "  --rate=HZ(" << INPUT_MIN_RATE << "-" << INPUT_MAX_RATE << ") --frame-rate=FPS --playout-ms=N\n";
+        std::cerr << "  --source=synthetic|trace:PATH|device:/dev/input/eventN\n";
+        std::cerr << "  --udp [--udp-loss=P --udp-reorder=P]  실시간 획을 UDP로 (손실/순서 바뀜 시뮬레이션)\n";
+        std::cerr << "  --canvas=fb:/dev/fb0|file:PATH  받은 획을 framebuffer에 그림\n";
+        std::cerr << "  --bench-points=N --bench-frames=N  (render-bench)\n";
         std::cerr << "예시: ./client_app draw _\n";
         std::cerr << "예시: ./client_app answer 사과\n";
+        std::cerr << "예시: ./client_app watch _ --server=127.0.0.1 --port=" << RELAY_PORT << "  (relay_app 경유 관전)\n";
+        std::cerr << "예시: ./client_app draw _ --server=127.0.0.1 --dev=/tmp/mydev\n";
+        std::cerr << "예시: ./client_app render-bench _ --canvas=fb:/dev/fb0 --bench-points=64\n";
         return 1;
     }
-    run_client(argv[1], argv[2]);
+    ClientOptions opts;
+    for (int i = 3; i < argc; ++i) {
+        std::string a = argv[i], v;
+        if (parse_option(a, "server", v)) opts.server_ip = v;
+        else if (parse_option(a, "port", v)) opts.server_port = std::atoi(v.c_str());
+        else if (parse_option(a, "room", v)) opts.room_id = std::atoi(v.c_str());
+        else if (parse_option(a, "max-player", v)) opts.max_player = std::atoi(v.c_str());
+        else if (parse_option(a, "dev", v)) opts.dev_path = v;
+        else if (parse_option(a, "rate", v)) opts.sample_rate = std::atoi(v.c_str());
+        else if (parse_option(a, "frame-rate", v)) opts.frame_rate = std::atoi(v.c_str());
+        else if (parse_option(a, "playout-ms", v)) opts.playout_ms = std::atoi(v.c_str());
+        else if (parse_option(a, "source", v)) opts.input_source = v;
+        else if (a == "--udp") opts.udp = true;
+        else if (parse_option(a, "udp-loss", v)) opts.udp_loss = std::atof(v.c_str());
+        else if (parse_option(a, "udp-reorder", v)) opts.udp_reorder = std::atof(v.c_str());
+        else if (parse_option(a, "canvas", v)) opts.canvas = v;
+        else if (parse_option(a, "bench-points", v)) opts.bench_points = std::atoi(v.c_str());
+        else if (parse_option(a, "bench-frames", v)) opts.bench_frames = std::atoi(v.c_str());
+        else { std::cerr << "unknown option: " << a << '\n'; return 1; }
+    }
+    if (opts.sample_rate < INPUT_MIN_RATE) opts.sample_rate = INPUT_MIN_RATE;
+    if (opts.sample_rate > INPUT_MAX_RATE) opts.sample_rate = INPUT_MAX_RATE;
+    if (opts.frame_rate <= 0) opts.frame_rate = 60;
+    if (opts.playout_ms < 0) opts.playout_ms = 0;
+    run_client(argv[1], argv[2], opts);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,87 @@
+#include "reactor.h"
+#include <cstdio>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+Reactor::Reactor() {
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd_ < 0) perror("epoll_create1");
+}
+
+Reactor::~Reactor() {
+    if (epfd_ >= 0) close(epfd_);
+}
+
+bool Reactor::add(int fd, uint32_t events, Handler handler) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl(ADD)");
+        return false;
+    }
+    handlers_[fd] = std::move(handler);
+    return true;
+}
+
+void Reactor::remove(int fd) {
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    handlers_.erase(fd);
+}
+
+static timespec to_timespec(std::chrono::nanoseconds ns) {
+    timespec ts{};
+    ts.tv_sec = ns.count() / 1000000000LL;
+    ts.tv_nsec = ns.count() % 1000000000LL;
+    return ts;
+}
+
+int Reactor::add_timer(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval,
+                       TimerHandler handler) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) { perror("timerfd_create"); return -1; }
+    bool ok = add(tfd, EPOLLIN, [tfd, handler = std::move(handler)](uint32_t) {
+        uint64_t expirations = 0;
+        if (read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+        handler(expirations);
+    });
+    if (!ok) { close(tfd); return -1; }
+    arm_timer(tfd, initial, interval);
+    return tfd;
+}
+
+void Reactor::arm_timer(int tfd, std::chrono::nanoseconds initial, std::chrono::nanoseconds interval) {
+    itimerspec its{};
+    its.it_value = to_timespec(initial);
+    its.it_interval = to_timespec(interval);
+    // it_value가 0이면 disarm이므로, 즉시 발화를 원하면 1ns로 보정
+    if (initial.count() == 0 && interval.count() != 0) its.it_value.tv_nsec = 1;
+    timerfd_settime(tfd, 0, &its, nullptr);
+}
+
+void Reactor::remove_timer(int tfd) {
+    remove(tfd);
+    close(tfd);
+}
+
+void Reactor::run() {
+    running_ = true;
+    epoll_event events[16];
+    while (running_) {
+        int n = epoll_wait(epfd_, events, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n && running_; ++i) {
+            auto it = handlers_.find(events[i].data.fd);
+            if (it == handlers_.end()) continue; // 처리 도중 제거된 fd
+            Handler handler = it->second;        // 핸들러 안에서 remove()해도 안전하도록 복사
+            handler(events[i].events);
+        }
+    }
+    running_ = false;
+}
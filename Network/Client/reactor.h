@@ -0,0 +1,41 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+// 단일 스레드 epoll 이벤트 루프
+// 소켓, /dev/mydev, timerfd를 하나의 루프에서 처리한다
+class Reactor {
+public:
+    using Handler = std::function<void(uint32_t events)>;
+    using TimerHandler = std::function<void(uint64_t expirations)>;
+
+    Reactor();
+    ~Reactor();
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    bool add(int fd, uint32_t events, Handler handler);
+    void remove(int fd);
+
+    // interval이 0이면 one-shot 타이머. 반환값은 timerfd (실패 시 -1)
+    int add_timer(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval,
+                  TimerHandler handler);
+    void arm_timer(int tfd, std::chrono::nanoseconds initial, std::chrono::nanoseconds interval);
+    void disarm_timer(int tfd) { arm_timer(tfd, std::chrono::nanoseconds(0), std::chrono::nanoseconds(0)); }
+    void remove_timer(int tfd);
+
+    void run();
+    void stop() { running_ = false; }
+    bool running() const { return running_; }
+
+private:
+    int epfd_;
+    bool running_ = false;
+    std::unordered_map<int, Handler> handlers_;
+};
+
+#endif // REACTOR_H
@@ -0,0 +1,91 @@
+#include "stroke_pipeline.h"
+
+// 재생이 이 이상 밀리면 보간을 포기하고 한 번에 따라잡는다
+#define JITTER_MAX_LAG_US 1000000
+// 경로 지연이 늘어난 경우를 따라가도록 offset 추정치를 점마다 조금씩 완화
+#define JITTER_OFFSET_RELAX_US 1
+
+static inline int32_t ts_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+bool StrokeBatcher::add(const InputSample& s, int color, int thick) {
+    int status;
+    if (s.pen_down && !was_down_) {
+        status = DRAW_STROKE_START;
+    } else if (s.pen_down) {
+        if (s.x == last_x_ && s.y == last_y_) return false; // 움직임 없음
+        status = DRAW_STROKE_CONTINUE;
+    } else if (was_down_) {
+        status = DRAW_STROKE_END;
+    } else {
+        return false; // pen-up 상태 유지
+    }
+    was_down_ = s.pen_down;
+    last_x_ = s.x;
+    last_y_ = s.y;
+
+    DrawPoint p{};
+    p.x = s.x;
+    p.y = s.y;
+    p.color = color;
+    p.thick = thick;
+    p.drawStatus = status;
+    p.t_us = (uint32_t)s.t_us;
+    pending_.push_back(p);
+    return pending_.size() >= MAX_DRAW_BATCH;
+}
+
+void JitterBuffer::push(const DrawPoint& p, uint64_t arrival_us) {
+    uint32_t transit = (uint32_t)arrival_us - p.t_us;
+    if (!has_offset_ || ts_diff(transit, offset_us_) < 0) {
+        offset_us_ = transit;
+        has_offset_ = true;
+    } else {
+        offset_us_ += JITTER_OFFSET_RELAX_US;
+    }
+    queue_.push_back(p);
+}
+
+void JitterBuffer::render(uint64_t now_us, std::vector<DrawPoint>& out) {
+    if (queue_.empty()) return;
+    uint32_t target = (uint32_t)now_us - offset_us_ - delay_us_;
+
+    // 너무 밀렸으면 남은 점을 모두 내보낸다
+    if (ts_diff(target, queue_.back().t_us) > JITTER_MAX_LAG_US) {
+        for (const DrawPoint& p : queue_) out.push_back(p);
+        last_ = queue_.back();
+        has_last_ = true;
+        queue_.clear();
+        return;
+    }
+
+    while (!queue_.empty() && ts_diff(queue_.front().t_us, target) <= 0) {
+        last_ = queue_.front();
+        has_last_ = true;
+        out.push_back(last_);
+        queue_.pop_front();
+    }
+
+    // 다음 점이 같은 획이면 target 시점 위치를 보간해 획 끝을 부드럽게 당겨온다
+    if (!has_last_ || queue_.empty()) return;
+    const DrawPoint& next = queue_.front();
+    if (next.drawStatus == DRAW_STROKE_START || last_.drawStatus == DRAW_STROKE_END) return;
+    int32_t span = ts_diff(next.t_us, last_.t_us);
+    int32_t into = ts_diff(target, last_.t_us);
+    if (span <= 0 || into <= 0 || into >= span) return;
+
+    DrawPoint mid = last_;
+    mid.x = last_.x + (int)((int64_t)(next.x - last_.x) * into / span);
+    mid.y = last_.y + (int)((int64_t)(next.y - last_.y) * into / span);
+    mid.drawStatus = DRAW_STROKE_CONTINUE;
+    mid.t_us = target;
+    if (mid.x == last_.x && mid.y == last_.y) return;
+    out.push_back(mid);
+    last_ = mid;
+}
+
+void JitterBuffer::clear() {
+    queue_.clear();
+    has_last_ = false;
+}
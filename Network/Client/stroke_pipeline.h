@@ -0,0 +1,46 @@
+#ifndef STROKE_PIPELINE_H
+#define STROKE_PIPELINE_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "input.h"
+#include "../Common/protocol.h"
+
+// 송신측: 샘플을 DrawPoint로 바꿔 모아두고, 프레임 타이머마다 MSG_DRAW_BATCH로 보낸다
+class StrokeBatcher {
+public:
+    // 배치가 가득 차면 true (호출 측이 즉시 flush)
+    bool add(const InputSample& s, int color, int thick);
+    bool empty() const { return pending_.empty(); }
+    const std::vector<DrawPoint>& points() const { return pending_; }
+    void clear() { pending_.clear(); }
+
+private:
+    std::vector<DrawPoint> pending_;
+    bool was_down_ = false;
+    int last_x_ = 0, last_y_ = 0;
+};
+
+// 수신측: 송신 타임스탬프 기준으로 playout delay만큼 늦춰 재생하고,
+// 같은 획 안의 두 점 사이는 렌더 시점에 맞춰 선형 보간한다
+class JitterBuffer {
+public:
+    explicit JitterBuffer(uint32_t playout_delay_us) : delay_us_(playout_delay_us) {}
+
+    void push(const DrawPoint& p, uint64_t arrival_us);
+    // now_us 시점에 그려야 할 점들을 out에 추가
+    void render(uint64_t now_us, std::vector<DrawPoint>& out);
+    void clear();
+    size_t pending() const { return queue_.size(); }
+
+private:
+    std::deque<DrawPoint> queue_;
+    uint32_t delay_us_;
+    bool has_offset_ = false;
+    uint32_t offset_us_ = 0;     // (수신 시각 - 송신 시각)의 최솟값 추정치
+    bool has_last_ = false;
+    DrawPoint last_{};           // 마지막으로 내보낸 점 (보간 기준)
+};
+
+#endif // STROKE_PIPELINE_H
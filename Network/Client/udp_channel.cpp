@@ -0,0 +1,154 @@
+#include "udp_channel.h"
+#include "../Common/frame_codec.h"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+UdpStrokeChannel::~UdpStrokeChannel() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool UdpStrokeChannel::open(const std::string& server_ip, int udp_port, uint32_t token, const LossSim& sim) {
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) { perror("socket(udp)"); return false; }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(udp_port);
+    addr.sin_addr.s_addr = inet_addr(server_ip.c_str());
+    if (connect(fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect(udp)");
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    token_ = token;
+    sim_ = sim;
+    return true;
+}
+
+void UdpStrokeChannel::send_hello() {
+    StrokeSegmentHeader hdr{};
+    hdr.type = MSG_STROKE_SEGMENT;
+    hdr.token = token_;
+    send(fd_, &hdr, sizeof(hdr), 0);
+}
+
+void UdpStrokeChannel::send_segment(StrokeSegment& seg) {
+    seg.hdr.token = token_;
+    int fd = fd_;
+    sim_.send(&seg, seg.bytes(), [fd](const void* buf, size_t len) { send(fd, buf, len, 0); });
+}
+
+bool UdpStrokeChannel::recv_segment(StrokeSegment& seg) {
+    ssize_t n = recv(fd_, &seg, sizeof(seg), 0);
+    if (n < (ssize_t)sizeof(StrokeSegmentHeader)) return false;
+    if (seg.hdr.type != MSG_STROKE_SEGMENT || seg.hdr.count < 0 || seg.hdr.count > MAX_STROKE_SEGMENT)
+        return false;
+    return (size_t)n == seg.bytes();
+}
+
+// ---------------- sender ----------------
+void StrokeSequencer::begin(StrokeSegment& seg, uint32_t stroke_id, uint32_t seq, int flags) {
+    seg.hdr = StrokeSegmentHeader{};
+    seg.hdr.type = MSG_STROKE_SEGMENT;
+    seg.hdr.stroke_id = stroke_id;
+    seg.hdr.first_seq = seq;
+    seg.hdr.flags = flags;
+}
+
+void StrokeSequencer::add(const std::vector<DrawPoint>& points, const SegmentFn& live_fn, const SegmentFn& sync_fn) {
+    live_.hdr.count = 0;
+    for (const DrawPoint& p : points) {
+        if (p.drawStatus == DRAW_STROKE_START || !started_ || next_seq_ == MAX_STROKE_POINTS) {
+            // 획이 바뀌면 이전 획의 live/sync를 먼저 보낸다
+            if (live_.hdr.count > 0) live_fn(live_);
+            flush_sync(sync_fn);
+            stroke_id_++;
+            next_seq_ = 0;
+            started_ = true;
+            begin(live_, stroke_id_, 0, SEGMENT_LIVE);
+        }
+        if (live_.hdr.count == 0) begin(live_, stroke_id_, next_seq_, SEGMENT_LIVE);
+        if (sync_.hdr.count == 0) begin(sync_, stroke_id_, next_seq_, SEGMENT_SYNC);
+        live_.points[live_.hdr.count++] = p;
+        sync_.points[sync_.hdr.count++] = p;
+        next_seq_++;
+        if (live_.hdr.count == MAX_STROKE_SEGMENT) { live_fn(live_); live_.hdr.count = 0; }
+        if (sync_.hdr.count == MAX_STROKE_SEGMENT) flush_sync(sync_fn);
+        if (p.drawStatus == DRAW_STROKE_END) {
+            if (live_.hdr.count > 0) { live_fn(live_); live_.hdr.count = 0; }
+            flush_sync(sync_fn);
+            started_ = false;
+        }
+    }
+    if (live_.hdr.count > 0) live_fn(live_);
+    live_.hdr.count = 0;
+}
+
+void StrokeSequencer::flush_sync(const SegmentFn& sync_fn) {
+    if (sync_.hdr.count == 0) return;
+    sync_fn(sync_);
+    sync_.hdr.count = 0;
+}
+
+// ---------------- receiver ----------------
+static bool newer(uint32_t stroke_a, uint32_t seq_a, uint32_t stroke_b, uint32_t seq_b) {
+    return stroke_a != stroke_b ? stroke_a > stroke_b : seq_a > seq_b;
+}
+
+void StrokeLog::accept(const StrokeSegment& seg, bool drop_stale,
+                       std::vector<DrawPoint>& out_live, std::vector<RepairedPoint>& out_repair) {
+    if (!stroke_seq_in_range(seg.hdr)) {
+        out_of_range++;
+        return;
+    }
+    PlayerStrokes& ps = players_[seg.hdr.player_id];
+    auto it = ps.strokes.find(seg.hdr.stroke_id);
+    if (it == ps.strokes.end()) {
+        // 남겨 둔 가장 오래된 획보다도 오래된 획은 다시 만들지 않는다
+        if (ps.strokes.size() >= STROKE_LOG_KEEP_STROKES && seg.hdr.stroke_id < ps.strokes.begin()->first) {
+            out_of_range++;
+            return;
+        }
+        it = ps.strokes.emplace(seg.hdr.stroke_id, Stroke{}).first;
+        while (ps.strokes.size() > STROKE_LOG_KEEP_STROKES) ps.strokes.erase(ps.strokes.begin());
+    }
+    Stroke& stroke = it->second;
+    for (int i = 0; i < seg.hdr.count; ++i) {
+        uint32_t seq = seg.hdr.first_seq + i;
+        bool is_new_head = !ps.has_head || newer(seg.hdr.stroke_id, seq, ps.head_stroke, ps.head_seq);
+        if (drop_stale && !is_new_head) {
+            stale_dropped++;
+            continue;
+        }
+        if (seq >= stroke.points.size()) {
+            stroke.points.resize(seq + 1);
+            stroke.have.resize(seq + 1, false);
+        }
+        if (stroke.have[seq]) continue; // 중복
+        stroke.have[seq] = true;
+        stroke.points[seq] = seg.points[i];
+
+        if (is_new_head) {
+            ps.has_head = true;
+            ps.head_stroke = seg.hdr.stroke_id;
+            ps.head_seq = seq;
+            out_live.push_back(seg.points[i]);
+        } else {
+            // 빈칸 양옆이 이미 그려져 있으면 그 점들과 이어 그린다 (획 경계는 넘지 않는다)
+            repaired++;
+            RepairedPoint r;
+            r.point = seg.points[i];
+            r.has_prev = seq > 0 && stroke.have[seq - 1] && r.point.drawStatus != DRAW_STROKE_START;
+            if (r.has_prev) r.prev = stroke.points[seq - 1];
+            r.has_next = seq + 1 < stroke.have.size() && stroke.have[seq + 1]
+                         && r.point.drawStatus != DRAW_STROKE_END
+                         && stroke.points[seq + 1].drawStatus != DRAW_STROKE_START;
+            if (r.has_next) r.next = stroke.points[seq + 1];
+            out_repair.push_back(r);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef UDP_CHANNEL_H
+#define UDP_CHANNEL_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Common/protocol.h"
+#include "../Common/loss_sim.h"
+
+#define STROKE_LOG_KEEP_STROKES 16   // 플레이어마다 보정용으로 남겨 두는 최근 획 수
+
+struct StrokeSegment {
+    StrokeSegmentHeader hdr{};
+    DrawPoint points[MAX_STROKE_SEGMENT];
+
+    size_t bytes() const { return sizeof(hdr) + hdr.count * sizeof(DrawPoint); }
+};
+
+// 서버와 연결된(connect) UDP 소켓. 송신은 LossSim을 거친다
+class UdpStrokeChannel {
+public:
+    ~UdpStrokeChannel();
+    bool open(const std::string& server_ip, int udp_port, uint32_t token, const LossSim& sim);
+    int fd() const { return fd_; }
+    void send_hello();
+    void send_segment(StrokeSegment& seg);
+    // non-blocking 수신. 형식이 맞는 datagram이면 true
+    bool recv_segment(StrokeSegment& seg);
+
+private:
+    int fd_ = -1;
+    uint32_t token_ = 0;
+    LossSim sim_;
+};
+
+// 그리는 쪽: 배치 점에 stroke_id/seq를 매기고 실시간 segment와 sync segment를 만든다
+class StrokeSequencer {
+public:
+    using SegmentFn = std::function<void(StrokeSegment&)>;
+
+    void add(const std::vector<DrawPoint>& points, const SegmentFn& live_fn, const SegmentFn& sync_fn);
+    // 쌓인 sync 점을 보낸다 (주기 타이머, 획 끝)
+    void flush_sync(const SegmentFn& sync_fn);
+
+private:
+    static void begin(StrokeSegment& seg, uint32_t stroke_id, uint32_t seq, int flags);
+
+    bool started_ = false;
+    uint32_t stroke_id_ = 0;
+    uint32_t next_seq_ = 0;
+    StrokeSegment live_;
+    StrokeSegment sync_;
+};
+
+// 뒤늦게 채워진 점 하나와 이미 받아 둔 같은 획의 앞뒤 점. prev -> point -> next 선분으로 다시 그린다
+struct RepairedPoint {
+    DrawPoint point{};
+    bool has_prev = false;
+    bool has_next = false;
+    DrawPoint prev{};
+    DrawPoint next{};
+};
+
+// 받는 쪽: (player, stroke, seq) 단위로 점을 모아 중복/오래된 점을 거르고 빠진 점을 보정한다
+class StrokeLog {
+public:
+    // drop_stale: UDP 실시간 경로에서는 최신 위치보다 오래된 점을 버린다
+    // out_live: 처음 보는 최신 점 (지터 버퍼로), out_repair: 뒤늦게 채워진 빈칸 (바로 그린다)
+    void accept(const StrokeSegment& seg, bool drop_stale,
+                std::vector<DrawPoint>& out_live, std::vector<RepairedPoint>& out_repair);
+    void clear() { players_.clear(); }
+
+    uint64_t stale_dropped = 0;
+    uint64_t repaired = 0;
+    uint64_t out_of_range = 0;   // seq가 MAX_STROKE_POINTS를 넘거나 이미 버린 획의 segment
+
+private:
+    struct Stroke {
+        std::vector<DrawPoint> points;
+        std::vector<bool> have;
+    };
+    struct PlayerStrokes {
+        bool has_head = false;
+        uint32_t head_stroke = 0;
+        uint32_t head_seq = 0;      // 지금까지 본 가장 최신 점
+        std::map<uint32_t, Stroke> strokes;   // 최근 STROKE_LOG_KEEP_STROKES개만
+    };
+    std::unordered_map<int, PlayerStrokes> players_;
+};
+
+#endif // UDP_CHANNEL_H
@@ -0,0 +1,82 @@
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sys/types.h>
+#include "protocol.h"
+
+// 서버 -> 클라이언트 방향 메시지 하나의 전체 길이
+// buf에 완전한 프레임이 있으면 길이, 더 받아야 하면 0, 알 수 없는/잘못된 프레임이면 -1
+// (relay처럼 메시지를 해석하지 않고 경계만 알아야 하는 곳에서 사용)
+inline ssize_t frame_length(const char* buf, size_t n) {
+    auto read_int = [buf](size_t off) { int v; std::memcpy(&v, buf + off, sizeof(v)); return v; };
+    auto read_u32 = [buf](size_t off) { uint32_t v; std::memcpy(&v, buf + off, sizeof(v)); return v; };
+    auto need = [n](size_t len) -> ssize_t { return n >= len ? (ssize_t)len : 0; };
+
+    if (n < sizeof(int)) return 0;
+    switch (read_int(0)) {
+        case MSG_DRAW:
+        case MSG_CLEAR:
+            return need(sizeof(DrawPacket));
+        case MSG_REJECTED:
+            return need(sizeof(int));
+        case MSG_PLAYER_NUM:
+            return need(sizeof(PlayerNumPacket));
+        case MSG_PLAYER_CNT:
+            return need(sizeof(PlayerCntPacket));
+        case MSG_SELECTED_PLAYER:
+            return need(sizeof(SelectedPlayerPacket));
+        case MSG_PLAYER_LEAVE:
+            return need(sizeof(PlayerLeavePacket));
+        case MSG_UDP_OFFER:
+            return need(sizeof(UdpOfferPacket));
+        case MSG_DRAW_BATCH: {
+            if (n < sizeof(DrawBatchHeader)) return 0;
+            int count = read_int(sizeof(int));
+            if (count < 0 || count > MAX_DRAW_BATCH) return -1;
+            return need(sizeof(DrawBatchHeader) + count * sizeof(DrawPoint));
+        }
+        case MSG_STROKE_SEGMENT: {
+            if (n < sizeof(StrokeSegmentHeader)) return 0;
+            StrokeSegmentHeader hdr;
+            std::memcpy(&hdr, buf, sizeof(hdr));
+            if (hdr.count < 0 || hdr.count > MAX_STROKE_SEGMENT) return -1;
+            return need(sizeof(StrokeSegmentHeader) + hdr.count * sizeof(DrawPoint));
+        }
+        case MSG_CORRECT:
+        case MSG_WRONG:
+        case MSG_ERROR:
+        case MSG_PLAYER_JOIN: {
+            // type, player_id, (uint32 len + bytes)
+            size_t off = 2 * sizeof(int);
+            if (n < off + sizeof(uint32_t)) return 0;
+            uint32_t len = read_u32(off);
+            if (len > MAX_MESSAGE_LEN) return -1;
+            return need(off + sizeof(uint32_t) + len);
+        }
+        case MSG_PLAYER_TABLE: {
+            if (n < sizeof(PlayerTableHeader)) return 0;
+            int count = read_int(sizeof(int));
+            if (count < 0 || count > MAX_PLAYER_TABLE) return -1;
+            size_t off = sizeof(PlayerTableHeader);
+            for (int i = 0; i < count; ++i) {
+                if (n < off + sizeof(int) + sizeof(uint32_t)) return 0;
+                uint32_t len = read_u32(off + sizeof(int));
+                if (len > MAX_MESSAGE_LEN) return -1;
+                off += sizeof(int) + sizeof(uint32_t) + len;
+            }
+            return need(off);
+        }
+        default:
+            return -1;
+    }
+}
+
+// seq(first_seq ~ first_seq + count - 1)가 MAX_STROKE_POINTS 안인지. 벗어난 segment는 relay/수신 모두 버린다
+inline bool stroke_seq_in_range(const StrokeSegmentHeader& hdr) {
+    return hdr.count >= 0 && (uint64_t)hdr.first_seq + hdr.count <= MAX_STROKE_POINTS;
+}
+
+#endif // FRAME_CODEC_H
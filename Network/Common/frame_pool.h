@@ -0,0 +1,102 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#define FRAME_SIZE 1024          // 한 메시지(인코딩된 프레임)의 최대 크기
+#define FRAME_SLAB_COUNT 64      // 풀이 비었을 때 한 번에 늘리는 프레임 수
+#define CONN_ARENA_SIZE 2048     // 연결당 디코딩용 scratch 메모리
+
+struct Frame {
+    size_t len = 0;
+    Frame* next_free = nullptr;
+    char data[FRAME_SIZE];
+
+    // n바이트를 그대로 덧붙인다. 공간이 부족하면 false
+    bool append(const void* p, size_t n) {
+        if (len + n > FRAME_SIZE) return false;
+        std::memcpy(data + len, p, n);
+        len += n;
+        return true;
+    }
+    // 길이(uint32) + 바이트 형식으로 덧붙인다 (서버 recv_string_view와 같은 형식)
+    bool append_string(std::string_view s) {
+        uint32_t n = s.size();
+        if (len + sizeof(n) + n > FRAME_SIZE) return false;
+        append(&n, sizeof(n));
+        return append(s.data(), n);
+    }
+};
+
+// 송신 프레임용 slab 풀. 워밍업 이후에는 free list 재사용만 하므로 힙 할당이 없다
+class FramePool {
+public:
+    Frame* acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_ == nullptr) grow();
+        Frame* f = free_;
+        free_ = f->next_free;
+        f->next_free = nullptr;
+        f->len = 0;
+        return f;
+    }
+    void release(Frame* f) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        f->next_free = free_;
+        free_ = f;
+    }
+
+private:
+    void grow() {
+        slabs_.emplace_back(new Frame[FRAME_SLAB_COUNT]);
+        Frame* slab = slabs_.back().get();
+        for (size_t i = 0; i < FRAME_SLAB_COUNT; ++i) {
+            slab[i].next_free = free_;
+            free_ = &slab[i];
+        }
+    }
+
+    std::mutex mutex_;
+    Frame* free_ = nullptr;
+    std::vector<std::unique_ptr<Frame[]>> slabs_;
+};
+
+// acquire/release를 묶는 RAII 핸들
+class PooledFrame {
+public:
+    explicit PooledFrame(FramePool& pool) : pool_(pool), frame_(pool.acquire()) {}
+    ~PooledFrame() { if (frame_) pool_.release(frame_); }
+    PooledFrame(const PooledFrame&) = delete;
+    PooledFrame& operator=(const PooledFrame&) = delete;
+
+    Frame* operator->() const { return frame_; }
+    Frame& operator*() const { return *frame_; }
+
+private:
+    FramePool& pool_;
+    Frame* frame_;
+};
+
+// 연결별 bump 할당 arena. 메시지 하나를 처리할 때마다 reset()
+class ConnArena {
+public:
+    char* alloc(size_t n) {
+        if (used_ + n > sizeof(buf_)) return nullptr;
+        char* p = buf_ + used_;
+        used_ += n;
+        return p;
+    }
+    void reset() { used_ = 0; }
+
+private:
+    char buf_[CONN_ARENA_SIZE];
+    size_t used_ = 0;
+};
+
+#endif // FRAME_POOL_H
@@ -0,0 +1,48 @@
+#ifndef LOSS_SIM_H
+#define LOSS_SIM_H
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+// 프로세스 안에서 흉내내는 tc/netem 스타일 손실/중복/순서 바뀜 (UDP 송신 경로용)
+// 모든 확률이 0이면 그대로 통과한다
+class LossSim {
+public:
+    LossSim(double drop = 0.0, double duplicate = 0.0, double reorder = 0.0, uint32_t seed = 1)
+        : drop_(drop), duplicate_(duplicate), reorder_(reorder), rng_(seed) {}
+
+    bool enabled() const { return drop_ > 0.0 || duplicate_ > 0.0 || reorder_ > 0.0; }
+
+    // send_fn(buf, len)을 0~3회 호출한다
+    template <typename SendFn>
+    void send(const void* buf, size_t len, SendFn&& send_fn) {
+        if (!enabled()) { send_fn(buf, len); return; }
+        if (chance(drop_)) return;
+        if (!has_held_ && len <= sizeof(held_) && chance(reorder_)) {
+            // 다음 datagram 뒤로 미룬다
+            std::memcpy(held_, buf, len);
+            held_len_ = len;
+            has_held_ = true;
+            return;
+        }
+        send_fn(buf, len);
+        if (chance(duplicate_)) send_fn(buf, len);
+        if (has_held_) {
+            send_fn(held_, held_len_);
+            has_held_ = false;
+        }
+    }
+
+private:
+    bool chance(double p) { return p > 0.0 && dist_(rng_) < p; }
+
+    double drop_, duplicate_, reorder_;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> dist_{0.0, 1.0};
+    char held_[2048];
+    size_t held_len_ = 0;
+    bool has_held_ = false;
+};
+
+#endif // LOSS_SIM_H
@@ -4,8 +4,10 @@
 #define SERVER_PORT 25000
 
 #include <string>
+#include <cstdint>
 
 #define MAX_CLIENTS 10
+#define MAX_MESSAGE_LEN 256   // 닉네임/정답/메시지 문자열 최대 길이
 #define MSG_SET_MAX_PLAYER 9999
 #define MSG_REJECTED 4004
 
@@ -19,7 +21,27 @@ enum MessageType {
     MSG_PLAYER_NUM = 7,
     MSG_DISCONNECT = 8,
     MSG_PLAYER_CNT = 9,
-    MSG_SELECTED_PLAYER = 10
+    MSG_SELECTED_PLAYER = 10,
+    MSG_DRAW_BATCH = 11,
+    MSG_PLAYER_TABLE = 12,
+    MSG_PLAYER_JOIN = 13,
+    MSG_PLAYER_LEAVE = 14,
+    MSG_UDP_REQUEST = 15,
+    MSG_UDP_OFFER = 16,
+    MSG_STROKE_SEGMENT = 17,
+    MSG_JOIN_ROOM = 18,
+    MSG_SPECTATE = 19,
+    MSG_ERROR = 20          // 요청한 클라이언트에게만: CommonPacket(type, player_id, message)
+};
+
+#define CANVAS_WIDTH 800
+#define CANVAS_HEIGHT 480
+
+// DrawPacket.drawStatus / DrawPoint.drawStatus
+enum DrawStatus {
+    DRAW_STROKE_START = 0,
+    DRAW_STROKE_CONTINUE = 1,
+    DRAW_STROKE_END = 2
 };
 
 struct DrawPacket {
@@ -31,26 +53,102 @@ struct DrawPacket {
     int drawStatus;
 };
 
+// MSG_DRAW_BATCH: DrawBatchHeader 뒤에 DrawPoint가 count개 이어진다
+// t_us는 송신측 CLOCK_MONOTONIC(us)의 하위 32비트 (차이는 int32_t로 계산)
+#define MAX_DRAW_BATCH 64
+
+struct DrawPoint {
+    int x;
+    int y;
+    int color;
+    int thick;
+    int drawStatus;
+    uint32_t t_us;
+};
+
+struct DrawBatchHeader {
+    int type;
+    int count;
+};
+
+// ---- UDP 획 채널 ----
+// 1) 입장 후 클라이언트가 TCP로 MSG_UDP_REQUEST를 보내면 서버가 MSG_UDP_OFFER(포트, token)로 응답
+// 2) 클라이언트는 UDP로 count=0 segment(hello)를 보내 주소를 등록하고, 이후 주기적으로 반복
+// 3) 실시간 점은 UDP StrokeSegment로 주고받고, 오래된 seq는 수신측이 버린다
+// 4) 그린 쪽은 같은 점을 TCP MSG_STROKE_SEGMENT(sync)로도 주기적으로 보내 최종 캔버스를 맞춘다
+#define MAX_STROKE_SEGMENT MAX_DRAW_BATCH
+#define MAX_STROKE_POINTS 4096   // 획 하나의 seq 상한. 그린 쪽은 넘기 전에 새 stroke_id로 이어 그린다
+#define STROKE_SYNC_INTERVAL_MS 250
+#define UDP_HELLO_INTERVAL_MS 1000
+
+struct UdpRequestPacket {
+    int type;
+};
+
+struct UdpOfferPacket {
+    int type;
+    int udp_port;
+    uint32_t token;
+};
+
+enum StrokeSegmentFlags {
+    SEGMENT_LIVE = 0,   // 실시간 점 (UDP, 또는 UDP 미사용 수신자에게 TCP로 relay)
+    SEGMENT_SYNC = 1    // 보정용 재전송 (TCP)
+};
+
+// UDP datagram / TCP MSG_STROKE_SEGMENT 공통 헤더. 뒤에 DrawPoint가 count개
+// 클라이언트 -> 서버 UDP에서는 token으로 송신자를 식별하고,
+// 서버 -> 수신자 방향에서는 player_id가 채워진다. 점의 seq는 first_seq부터 1씩 증가
+struct StrokeSegmentHeader {
+    int type;           // MSG_STROKE_SEGMENT
+    uint32_t token;
+    int player_id;
+    uint32_t stroke_id;
+    uint32_t first_seq;
+    int count;
+    int flags;
+};
+
+// gateway 경유 시 가장 먼저 보내는 방 번호. gateway가 소비하고 backend로는 넘기지 않는다
+// (server_app에 직접 접속해서 보내도 무시된다)
+#define GATEWAY_PORT 24000
+
+struct JoinRoomPacket {
+    int type;
+    int room_id;
+};
+
+// relay_app 기본 포트. origin(server_app)에 관전자 하나로 붙어서 다수의 관전자에게 다시 뿌린다
+#define RELAY_PORT 26000
+
+// 관전자: MSG_SET_MAX_PLAYER 대신 보내면 인원 제한 없이 읽기 전용으로 모든 broadcast를 받는다
+// 접속 직후 현재 상태(플레이어 목록, 인원, 출제자, 마지막 clear 이후 획)를 먼저 받는다
+struct SpectatePacket {
+    int type;
+};
+
 struct AnswerPacket {
     int type;
     std::string nickname;
     std::string answer;
 };
 
+// 닉네임은 입장 시 MSG_PLAYER_TABLE / MSG_PLAYER_JOIN으로 한 번만 보내고
+// 이후 메시지는 player_id만 싣는다
 struct CorrectPacket {
     int type;
-    std::string nickname;
+    int player_id;
 };
 
 struct WrongPacket {
     int type;
     std::string message;
-    std::string nickname;
+    int player_id;
 };
 
 struct CommonPacket {
     int type;
-    std::string nickname;
+    int player_id;
     std::string message;
 };
 
@@ -67,7 +165,20 @@ struct PlayerCntPacket {
 
 struct SelectedPlayerPacket {
     int type;
-    std::string nickname;
+    int player_id;
+};
+
+// MSG_PLAYER_TABLE: PlayerTableHeader 뒤에 (int player_id, string nickname)이 count개
+// MSG_PLAYER_JOIN:  int type, int player_id, string nickname
+#define MAX_PLAYER_TABLE 65536   // max player는 방장이 정하므로 MAX_CLIENTS보다 클 수 있다
+struct PlayerTableHeader {
+    int type;
+    int count;
+};
+
+struct PlayerLeavePacket {
+    int type;
+    int player_id;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Common/protocol.h"
+
+#define RING_VNODES 64   // backend 하나당 ring 위의 가상 노드 수
+
+struct BackendAddr {
+    std::string host;
+    unsigned short port;
+
+    std::string key() const { return host + ":" + std::to_string(port); }
+    bool operator==(const BackendAddr& o) const { return host == o.host && port == o.port; }
+};
+
+// 방 번호 -> backend consistent hashing
+// backend가 추가/삭제되면 그 backend에 걸린 구간의 방만 옮겨진다
+class HashRing {
+public:
+    void build(const std::vector<BackendAddr>& backends);
+    bool empty() const { return ring_.empty(); }
+    // 방의 hash 위치부터 ring을 돌며 만나는 순서대로 backend (중복 없음)
+    std::vector<const BackendAddr*> preference(int room_id) const;
+
+private:
+    std::vector<BackendAddr> backends_;
+    std::map<uint32_t, size_t> ring_;   // hash -> backends_ index
+};
+
+struct GatewayOptions {
+    unsigned short port = GATEWAY_PORT;
+    std::vector<BackendAddr> backends;
+    std::string backends_file;          // SIGHUP 때 다시 읽어 rebalance
+};
+
+void run_gateway(const GatewayOptions& opts);
+
+#endif // GATEWAY_H
@@ -0,0 +1,351 @@
+#include "gateway.h"
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#define SPLICE_CHUNK 65536
+
+static uint32_t fnv1a(const std::string& s) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 16777619u;
+    }
+    // 짧은 키가 ring 위에서 고르게 퍼지도록 마무리 섞기
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+void HashRing::build(const std::vector<BackendAddr>& backends) {
+    backends_ = backends;
+    ring_.clear();
+    for (size_t i = 0; i < backends_.size(); ++i)
+        for (int v = 0; v < RING_VNODES; ++v)
+            ring_[fnv1a(backends_[i].key() + "#" + std::to_string(v))] = i;
+}
+
+std::vector<const BackendAddr*> HashRing::preference(int room_id) const {
+    std::vector<const BackendAddr*> out;
+    if (ring_.empty()) return out;
+    std::vector<bool> seen(backends_.size(), false);
+    auto it = ring_.lower_bound(fnv1a("room" + std::to_string(room_id)));
+    for (size_t step = 0; step < ring_.size() && out.size() < backends_.size(); ++step, ++it) {
+        if (it == ring_.end()) it = ring_.begin();
+        if (seen[it->second]) continue;
+        seen[it->second] = true;
+        out.push_back(&backends_[it->second]);
+    }
+    return out;
+}
+
+// ---------------- 세션 / 방 배정 ----------------
+struct Session {
+    int client_fd;
+    int backend_fd;
+    int room_id;
+    std::string backend_key;
+    std::atomic<int> open_dirs{2};
+};
+
+static std::mutex gw_mutex;
+static HashRing ring;
+static std::vector<BackendAddr> backend_list;
+// 진행 중인 방은 처음 배정된 backend에 고정 (게임 상태가 그 프로세스에 있다)
+// server_app 하나가 방 하나이므로 backend 하나에는 방 하나만 고정한다
+static std::unordered_map<int, std::pair<BackendAddr, int>> room_pins;   // room -> (backend, 세션 수)
+static std::vector<std::shared_ptr<Session>> sessions;
+
+static bool backend_alive(const BackendAddr& b) {
+    return std::find(backend_list.begin(), backend_list.end(), b) != backend_list.end();
+}
+
+static bool backend_taken(const BackendAddr& b, int except_room) {
+    for (const auto& pin : room_pins)
+        if (pin.first != except_room && pin.second.first == b) return true;
+    return false;
+}
+
+// 방에 쓸 backend를 고르고 세션 하나만큼 고정한다 (gw_mutex 보유 상태)
+// ring 순서대로 다른 방이 쓰지 않는 backend를 찾고, 모두 쓰는 중이면 false
+static bool assign_backend(int room_id, BackendAddr& out) {
+    auto pin = room_pins.find(room_id);
+    if (pin != room_pins.end() && backend_alive(pin->second.first)) {
+        out = pin->second.first;
+        pin->second.second++;
+        return true;
+    }
+    for (const BackendAddr* b : ring.preference(room_id)) {
+        if (backend_taken(*b, room_id)) continue;
+        // 사라진 backend에 걸려 있던 고정은 새 backend로 바꾼다 (끊기는 중인 옛 세션은 세지 않음)
+        room_pins[room_id] = {*b, 1};
+        out = *b;
+        return true;
+    }
+    return false;
+}
+
+// 세션 하나가 끝났을 때. 이미 다른 backend로 다시 고정된 방이면 건드리지 않는다
+static void unpin_room(int room_id, const std::string& backend_key) {
+    auto pin = room_pins.find(room_id);
+    if (pin == room_pins.end() || pin->second.first.key() != backend_key) return;
+    if (--pin->second.second <= 0) room_pins.erase(pin);
+}
+
+static int connect_backend(const BackendAddr& b) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(b.port);
+    addr.sin_addr.s_addr = inet_addr(b.host.c_str());
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror(("connect " + b.key()).c_str());
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// ---------------- 중계 ----------------
+// socket -> pipe -> socket splice: 사용자 공간 복사 없이 프레임을 그대로 전달
+static void relay(std::shared_ptr<Session> s, int from, int to) {
+    int p[2];
+    if (pipe2(p, O_CLOEXEC) == 0) {
+        while (true) {
+            ssize_t n = splice(from, nullptr, p[1], nullptr, SPLICE_CHUNK, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            bool ok = true;
+            while (n > 0) {
+                ssize_t m = splice(p[0], nullptr, to, nullptr, n, SPLICE_F_MOVE | SPLICE_F_MORE);
+                if (m < 0 && errno == EINTR) continue;
+                if (m <= 0) { ok = false; break; }
+                n -= m;
+            }
+            if (!ok) break;
+        }
+        close(p[0]);
+        close(p[1]);
+    }
+    // 한 방향이 끝나면 상대편에 FIN을 넘기고, 반대 방향 스레드도 깨운다
+    shutdown(to, SHUT_WR);
+    shutdown(from, SHUT_RD);
+
+    if (--s->open_dirs == 0) {
+        {
+            std::lock_guard<std::mutex> lock(gw_mutex);
+            unpin_room(s->room_id, s->backend_key);
+            sessions.erase(std::remove(sessions.begin(), sessions.end(), s), sessions.end());
+        }
+        close(s->client_fd);
+        close(s->backend_fd);
+        std::cout << "[gateway] room " << s->room_id << " session closed\n";
+    }
+}
+
+static void handle_connection(int client_fd) {
+    // 첫 메시지가 MSG_JOIN_ROOM이면 소비하고, 아니면 방 0
+    int room_id = 0;
+    int peek_type = 0;
+    if (recv(client_fd, &peek_type, sizeof(peek_type), MSG_PEEK | MSG_WAITALL) != sizeof(peek_type)) {
+        close(client_fd);
+        return;
+    }
+    if (peek_type == MSG_JOIN_ROOM) {
+        JoinRoomPacket pkt;
+        if (recv(client_fd, &pkt, sizeof(pkt), MSG_WAITALL) != sizeof(pkt)) {
+            close(client_fd);
+            return;
+        }
+        room_id = pkt.room_id;
+    }
+
+    // 연결하는 동안 다른 방이 같은 backend를 고르지 않도록 먼저 고정해 둔다
+    BackendAddr backend;
+    bool assigned;
+    {
+        std::lock_guard<std::mutex> lock(gw_mutex);
+        assigned = assign_backend(room_id, backend);
+    }
+    int backend_fd = assigned ? connect_backend(backend) : -1;
+    if (backend_fd < 0) {
+        if (assigned) {
+            std::lock_guard<std::mutex> lock(gw_mutex);
+            unpin_room(room_id, backend.key());
+        }
+        std::cerr << "[gateway] no free backend for room " << room_id << '\n';
+        int reject_type = MSG_REJECTED;
+        send(client_fd, &reject_type, sizeof(reject_type), MSG_NOSIGNAL);
+        close(client_fd);
+        return;
+    }
+
+    auto s = std::make_shared<Session>();
+    s->client_fd = client_fd;
+    s->backend_fd = backend_fd;
+    s->room_id = room_id;
+    s->backend_key = backend.key();
+    {
+        std::lock_guard<std::mutex> lock(gw_mutex);
+        sessions.push_back(s);
+    }
+    std::cout << "[gateway] room " << room_id << " -> " << backend.key() << '\n';
+
+    std::thread(relay, s, backend_fd, client_fd).detach();
+    relay(s, client_fd, backend_fd);
+}
+
+// ---------------- backend 목록 ----------------
+static bool parse_backend(const std::string& spec, BackendAddr& out) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return false;
+    out.host = spec.substr(0, colon);
+    out.port = (unsigned short)std::atoi(spec.c_str() + colon + 1);
+    return !out.host.empty() && out.port != 0;
+}
+
+static void parse_backend_list(const std::string& list, std::vector<BackendAddr>& out) {
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        BackendAddr b;
+        if (parse_backend(list.substr(start, comma - start), b)) out.push_back(b);
+        start = comma + 1;
+    }
+}
+
+static bool load_backends_file(const std::string& path, std::vector<BackendAddr>& out) {
+    std::ifstream in(path);
+    if (!in) { perror(path.c_str()); return false; }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        BackendAddr b;
+        if (parse_backend(line, b)) out.push_back(b);
+    }
+    return true;
+}
+
+// backend 목록 교체. 사라진 backend의 세션은 끊어서 클라이언트가 재접속하면 새 ring으로 배정된다
+static void apply_backends(const std::vector<BackendAddr>& backends) {
+    std::lock_guard<std::mutex> lock(gw_mutex);
+    backend_list = backends;
+    ring.build(backend_list);
+    // 사라진 backend에 고정된 방은 풀어서 다음 입장 때 새로 배정한다
+    for (auto it = room_pins.begin(); it != room_pins.end();) {
+        if (backend_alive(it->second.first)) ++it;
+        else it = room_pins.erase(it);
+    }
+    for (auto& s : sessions) {
+        bool alive = std::any_of(backend_list.begin(), backend_list.end(),
+            [&s](const BackendAddr& b) { return b.key() == s->backend_key; });
+        if (!alive) {
+            shutdown(s->client_fd, SHUT_RDWR);
+            shutdown(s->backend_fd, SHUT_RDWR);
+        }
+    }
+    std::cout << "[gateway] " << backend_list.size() << " backend(s):";
+    for (const auto& b : backend_list) std::cout << ' ' << b.key();
+    std::cout << std::endl;
+}
+
+void run_gateway(const GatewayOptions& opts) {
+    signal(SIGPIPE, SIG_IGN);
+    // SIGHUP은 스레드를 만들기 전에 막아서 중계 스레드들도 물려받게 하고, accept 루프가 signalfd로 받는다
+    sigset_t hup;
+    sigemptyset(&hup);
+    sigaddset(&hup, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &hup, nullptr);
+    int sig_fd = signalfd(-1, &hup, SFD_CLOEXEC);
+    if (sig_fd < 0) { perror("signalfd"); exit(1); }
+
+    std::vector<BackendAddr> initial = opts.backends;
+    if (!opts.backends_file.empty()) load_backends_file(opts.backends_file, initial);
+    apply_backends(initial);
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) { perror("socket"); exit(1); }
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(opts.port);
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); exit(1); }
+    if (listen(listen_fd, 128) < 0) { perror("listen"); exit(1); }
+    std::cout << "[gateway] port " << opts.port << "에서 대기중...\n";
+
+    pollfd fds[2] = {{listen_fd, POLLIN, 0}, {sig_fd, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno != EINTR) perror("poll");
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            signalfd_siginfo si;
+            if (read(sig_fd, &si, sizeof(si)) == sizeof(si) && !opts.backends_file.empty()) {
+                std::vector<BackendAddr> backends;
+                if (load_backends_file(opts.backends_file, backends)) apply_backends(backends);
+            }
+        }
+        if (!(fds[0].revents & POLLIN)) continue;
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno != EINTR) perror("accept");
+            continue;
+        }
+        int one = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::thread(handle_connection, client_fd).detach();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    GatewayOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const std::string port_opt = "--port=";
+        const std::string backends_opt = "--backends=";
+        const std::string file_opt = "--backends-file=";
+        if (a.compare(0, port_opt.size(), port_opt) == 0) {
+            opts.port = (unsigned short)std::stoi(a.substr(port_opt.size()));
+        } else if (a.compare(0, backends_opt.size(), backends_opt) == 0) {
+            parse_backend_list(a.substr(backends_opt.size()), opts.backends);
+        } else if (a.compare(0, file_opt.size(), file_opt) == 0) {
+            opts.backends_file = a.substr(file_opt.size());
+        } else {
+            std::cerr << "unknown option: " << a << '\n';
+            opts.backends.clear();
+            opts.backends_file.clear();
+            break;
+        }
+    }
+    if (opts.backends.empty() && opts.backends_file.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--port=N] --backends=HOST:PORT[,HOST:PORT...] | --backends-file=PATH\n";
+        std::cerr << "예시: ./gateway_app --backends=127.0.0.1:25001,127.0.0.1:25002\n";
+        std::cerr << "      backends-file은 한 줄에 HOST:PORT, kill -HUP 으로 다시 읽는다\n";
+        return 1;
+    }
+    run_gateway(opts);
+    return 0;
+}
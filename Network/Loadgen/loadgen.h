@@ -0,0 +1,30 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <string>
+#include <vector>
+#include "../Common/protocol.h"
+
+#define LOADGEN_RECV_TIMEOUT_S 10   // 이 시간 동안 아무것도 못 받으면 수신자 실패로 본다
+
+// 빈 server_app 하나에 송신자 1명 + 수신자 receivers명으로 입장해서
+// 송신자가 보낸 MSG_DRAW_BATCH가 모든 수신자에게 도착할 때까지의 시간을 잰다
+struct LoadgenOptions {
+    std::string host = "127.0.0.1";
+    unsigned short port = SERVER_PORT;
+    int receivers = 32;
+    int batches = 2000;
+    int points = MAX_DRAW_BATCH;   // batch 하나의 점 개수
+};
+
+// 서버가 보내는 프레임을 경계 단위로 읽기 위한 연결 하나
+struct LoadgenConn {
+    int fd = -1;
+    std::vector<char> buf;
+    size_t start = 0;   // buf에서 아직 꺼내지 않은 첫 바이트
+};
+
+// 성공하면 true. 결과는 stdout에 출력
+bool run_loadgen(const LoadgenOptions& opts);
+
+#endif // LOADGEN_H
@@ -0,0 +1,191 @@
+#include "loadgen.h"
+#include "../Common/frame_codec.h"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#define LOADGEN_READ_CHUNK 65536
+
+static int connect_server(const LoadgenOptions& opts) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opts.port);
+    inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval tv{LOADGEN_RECV_TIMEOUT_S, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static bool send_all(int fd, const void* p, size_t len) {
+    const char* c = static_cast<const char*>(p);
+    while (len > 0) {
+        ssize_t n = send(fd, c, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        c += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 완전한 프레임 하나의 type을 돌려준다. 연결이 끊겼거나 시간 초과, 잘못된 프레임이면 -1
+static int next_frame(LoadgenConn& c) {
+    while (true) {
+        ssize_t len = frame_length(c.buf.data() + c.start, c.buf.size() - c.start);
+        if (len < 0) return -1;
+        if (len > 0) {
+            int type;
+            std::memcpy(&type, c.buf.data() + c.start, sizeof(type));
+            c.start += len;
+            return type;
+        }
+        // 남은 조각을 앞으로 당기고 더 읽는다
+        c.buf.erase(c.buf.begin(), c.buf.begin() + c.start);
+        c.start = 0;
+        size_t old = c.buf.size();
+        c.buf.resize(old + LOADGEN_READ_CHUNK);
+        ssize_t n = recv(c.fd, c.buf.data() + old, LOADGEN_READ_CHUNK, 0);
+        c.buf.resize(old + (n > 0 ? n : 0));
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return -1;
+        }
+    }
+}
+
+// 입장: MSG_SET_MAX_PLAYER를 보내고 MSG_PLAYER_NUM을 받을 때까지 기다린다
+static bool join(LoadgenConn& c, int max_player) {
+    int msg[2] = {MSG_SET_MAX_PLAYER, max_player};
+    if (!send_all(c.fd, msg, sizeof(msg))) return false;
+    while (true) {
+        int type = next_frame(c);
+        if (type == MSG_PLAYER_NUM) return true;
+        if (type < 0 || type == MSG_REJECTED) return false;
+    }
+}
+
+bool run_loadgen(const LoadgenOptions& opts) {
+    const int total = opts.receivers + 1;
+    std::vector<LoadgenConn> conns(total);
+    // 한 명씩 입장 완료를 확인해야 첫 클라이언트가 정한 max_Player와 경쟁하지 않는다
+    for (int i = 0; i < total; ++i) {
+        conns[i].fd = connect_server(opts);
+        if (conns[i].fd < 0 || !join(conns[i], total)) {
+            std::cerr << "[loadgen] " << i << "번째 연결 입장 실패 (빈 서버에 접속했는지 확인)\n";
+            for (auto& c : conns) if (c.fd >= 0) close(c.fd);
+            return false;
+        }
+    }
+
+    std::atomic<int> failed{0};
+    std::vector<std::chrono::steady_clock::time_point> done_at(total);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < total; ++i) {
+        threads.emplace_back([&, i]() {
+            int got = 0;
+            while (got < opts.batches) {
+                int type = next_frame(conns[i]);
+                if (type < 0) {
+                    failed++;
+                    return;
+                }
+                if (type == MSG_DRAW_BATCH) got++;
+            }
+            done_at[i] = std::chrono::steady_clock::now();
+        });
+    }
+
+    std::vector<char> frame(sizeof(DrawBatchHeader) + opts.points * sizeof(DrawPoint));
+    DrawBatchHeader hdr{MSG_DRAW_BATCH, opts.points};
+    std::memcpy(frame.data(), &hdr, sizeof(hdr));
+    DrawPoint* pts = reinterpret_cast<DrawPoint*>(frame.data() + sizeof(hdr));
+    for (int p = 0; p < opts.points; ++p)
+        pts[p] = DrawPoint{p, p, 0, 1, p == 0 ? DRAW_STROKE_START : DRAW_STROKE_CONTINUE, 0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < opts.batches; ++b) {
+        if (!send_all(conns[0].fd, frame.data(), frame.size())) {
+            perror("send");
+            failed++;
+            break;
+        }
+    }
+    for (auto& t : threads) t.join();
+    for (auto& c : conns) close(c.fd);
+    if (failed > 0) {
+        std::cerr << "[loadgen] 수신자 " << failed << "명이 batch를 다 받지 못함\n";
+        return false;
+    }
+
+    auto end = start;
+    for (int i = 1; i < total; ++i) if (done_at[i] > end) end = done_at[i];
+    double sec = std::chrono::duration<double>(end - start).count();
+    double delivered = (double)opts.batches * opts.receivers;
+    std::cout << "[loadgen] receivers=" << opts.receivers << " batches=" << opts.batches
+              << " points=" << opts.points << '\n';
+    std::cout << "[loadgen] " << sec * 1000.0 << " ms, " << (long long)(delivered / sec)
+              << " batches/s delivered, "
+              << (delivered * frame.size()) / sec / (1024.0 * 1024.0) << " MiB/s\n";
+    return true;
+}
+
+static bool parse_option(const std::string& a, const char* key, std::string& value) {
+    std::string prefix = std::string("--") + key + "=";
+    if (a.compare(0, prefix.size(), prefix) != 0) return false;
+    value = a.substr(prefix.size());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    LoadgenOptions opts;
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i], v;
+        if (parse_option(a, "server", v)) {
+            size_t colon = v.rfind(':');
+            opts.host = v.substr(0, colon);
+            if (colon != std::string::npos) opts.port = (unsigned short)std::atoi(v.c_str() + colon + 1);
+        } else if (parse_option(a, "receivers", v)) {
+            opts.receivers = std::atoi(v.c_str());
+        } else if (parse_option(a, "batches", v)) {
+            opts.batches = std::atoi(v.c_str());
+        } else if (parse_option(a, "points", v)) {
+            opts.points = std::atoi(v.c_str());
+        } else {
+            std::cerr << "unknown option: " << a << '\n';
+            ok = false;
+        }
+    }
+    if (opts.receivers < 1 || opts.batches < 1 || opts.points < 1 || opts.points > MAX_DRAW_BATCH) ok = false;
+    if (!ok) {
+        std::cerr << "usage: " << argv[0] << " [--server=HOST:PORT] [--receivers=N] [--batches=N] [--points=1.."
+                  << MAX_DRAW_BATCH << "]\n";
+        std::cerr << "예시: ./server_app 사과 --io=uring & ./loadgen_app --server=127.0.0.1:" << SERVER_PORT
+                  << " --receivers=32 --batches=2000\n";
+        std::cerr << "      서버는 비어 있어야 한다 (첫 연결이 max_Player를 정함)\n";
+        return 1;
+    }
+    return run_loadgen(opts) ? 0 : 1;
+}
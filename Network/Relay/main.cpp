@@ -0,0 +1,386 @@
+#include "relay.h"
+#include "../Common/frame_codec.h"
+#include <iostream>
+#include <unordered_map>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define RELAY_READ_CHUNK 65536
+#define RELAY_MAX_EVENTS 256
+
+// ---------------- 스냅샷 ----------------
+static void append_bytes(std::vector<char>& out, const void* p, size_t len) {
+    const char* c = static_cast<const char*>(p);
+    out.insert(out.end(), c, c + len);
+}
+
+static void append_string(std::vector<char>& out, const std::string& s) {
+    uint32_t len = s.size();
+    append_bytes(out, &len, sizeof(len));
+    append_bytes(out, s.data(), s.size());
+}
+
+// (uint32 len + bytes) 문자열 하나. frame_length로 이미 검증된 프레임 안에서만 호출
+static std::string read_string(const char* p, size_t& off) {
+    uint32_t len;
+    std::memcpy(&len, p + off, sizeof(len));
+    off += sizeof(len);
+    std::string s(p + off, len);
+    off += len;
+    return s;
+}
+
+void RoomSnapshot::apply(const char* frame, size_t len) {
+    int type;
+    std::memcpy(&type, frame, sizeof(type));
+    switch (type) {
+        case MSG_PLAYER_TABLE: {
+            PlayerTableHeader hdr;
+            std::memcpy(&hdr, frame, sizeof(hdr));
+            players_.clear();
+            size_t off = sizeof(hdr);
+            for (int i = 0; i < hdr.count; ++i) {
+                int id;
+                std::memcpy(&id, frame + off, sizeof(id));
+                off += sizeof(id);
+                players_[id] = read_string(frame, off);
+            }
+            break;
+        }
+        case MSG_PLAYER_JOIN: {
+            int id;
+            std::memcpy(&id, frame + sizeof(int), sizeof(id));
+            size_t off = 2 * sizeof(int);
+            players_[id] = read_string(frame, off);
+            break;
+        }
+        case MSG_PLAYER_LEAVE: {
+            PlayerLeavePacket pkt;
+            std::memcpy(&pkt, frame, sizeof(pkt));
+            players_.erase(pkt.player_id);
+            break;
+        }
+        case MSG_PLAYER_CNT:
+            player_cnt_.assign(frame, frame + len);
+            break;
+        case MSG_SELECTED_PLAYER:
+            selected_.assign(frame, frame + len);
+            break;
+        case MSG_CLEAR:
+            strokes_.clear();
+            break;
+        case MSG_STROKE_SEGMENT: {
+            // live 조각은 sync 조각에 다시 들어있으므로 sync만 기록
+            StrokeSegmentHeader hdr;
+            std::memcpy(&hdr, frame, sizeof(hdr));
+            if (hdr.flags != SEGMENT_SYNC) break;
+        }
+        // fall through
+        case MSG_DRAW:
+        case MSG_DRAW_BATCH:
+            if (strokes_.size() + len <= RELAY_STROKE_MAX_BYTES) append_bytes(strokes_, frame, len);
+            break;
+        default:
+            break;   // 정답/오답 알림 등은 지나간 일이라 스냅샷에 넣지 않는다
+    }
+}
+
+void RoomSnapshot::reset() {
+    players_.clear();
+    player_cnt_.clear();
+    selected_.clear();
+    strokes_.clear();
+}
+
+SharedBuf RoomSnapshot::build() const {
+    auto out = std::make_shared<std::vector<char>>();
+    out->reserve(strokes_.size() + 256);
+    PlayerTableHeader hdr{MSG_PLAYER_TABLE, (int)players_.size()};
+    append_bytes(*out, &hdr, sizeof(hdr));
+    for (const auto& p : players_) {
+        append_bytes(*out, &p.first, sizeof(p.first));
+        append_string(*out, p.second);
+    }
+    out->insert(out->end(), player_cnt_.begin(), player_cnt_.end());
+    out->insert(out->end(), selected_.begin(), selected_.end());
+    out->insert(out->end(), strokes_.begin(), strokes_.end());
+    return out;
+}
+
+// ---------------- 관전자 송신 큐 ----------------
+static int epfd = -1;
+static std::unordered_map<int, Spectator> spectators;
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void drop_spectator(int fd, const char* reason) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    spectators.erase(fd);
+    std::cout << "[relay] spectator " << fd << " 끊음 (" << reason << "), 남은 관전자 " << spectators.size() << '\n';
+}
+
+static void update_interest(Spectator& sp) {
+    bool want = !sp.queue.empty();
+    if (want == sp.want_write) return;
+    sp.want_write = want;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | (want ? (uint32_t)EPOLLOUT : 0u);
+    ev.data.fd = sp.fd;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, sp.fd, &ev);
+}
+
+// 큐가 빌 때까지 또는 소켓 버퍼가 찰 때까지 보낸다. 연결이 끊겼으면 false
+static bool flush_spectator(Spectator& sp) {
+    while (!sp.queue.empty()) {
+        auto& head = sp.queue.front();
+        const std::vector<char>& buf = *head.first;
+        ssize_t n = send(sp.fd, buf.data() + head.second, buf.size() - head.second, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        head.second += n;
+        sp.queued_bytes -= n;
+        if (head.second == buf.size()) sp.queue.pop_front();
+    }
+    update_interest(sp);
+    return true;
+}
+
+static void enqueue(Spectator& sp, const SharedBuf& buf) {
+    if (buf->empty()) return;
+    bool was_empty = sp.queue.empty();
+    sp.queue.emplace_back(buf, 0);
+    sp.queued_bytes += buf->size();
+    if (sp.queued_bytes > RELAY_MAX_QUEUE_BYTES) {
+        drop_spectator(sp.fd, "송신 큐 초과");
+        return;
+    }
+    // 밀려 있지 않은 관전자에게는 바로 보낸다 (대부분의 경우 epoll을 거치지 않음)
+    if (was_empty && !flush_spectator(sp)) drop_spectator(sp.fd, "send 실패");
+}
+
+static void fan_out(const SharedBuf& buf) {
+    // enqueue가 관전자를 지울 수 있으므로 fd 목록을 먼저 뜬다
+    std::vector<int> fds;
+    fds.reserve(spectators.size());
+    for (const auto& s : spectators) fds.push_back(s.first);
+    for (int fd : fds) {
+        auto it = spectators.find(fd);
+        if (it != spectators.end()) enqueue(it->second, buf);
+    }
+}
+
+// ---------------- origin ----------------
+static int connect_origin(const RelayOptions& opts) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opts.origin_port);
+    addr.sin_addr.s_addr = inet_addr(opts.origin_host.c_str());
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect origin");
+        close(fd);
+        return -1;
+    }
+    if (opts.room_id >= 0) {
+        JoinRoomPacket room_pkt{MSG_JOIN_ROOM, opts.room_id};
+        send(fd, &room_pkt, sizeof(room_pkt), MSG_NOSIGNAL);
+    }
+    SpectatePacket spec_pkt{MSG_SPECTATE};
+    if (send(fd, &spec_pkt, sizeof(spec_pkt), MSG_NOSIGNAL) != sizeof(spec_pkt)) {
+        close(fd);
+        return -1;
+    }
+    set_nonblocking(fd);
+    std::cout << "[relay] origin " << opts.origin_host << ':' << opts.origin_port << " 구독 시작\n";
+    return fd;
+}
+
+// origin에서 읽은 바이트를 프레임 단위로 잘라 스냅샷에 반영하고, 완성된 프레임들을 한 버퍼로 묶어 뿌린다
+// origin 연결이 끊겼거나 스트림이 깨졌으면 false
+static bool on_origin_readable(int fd, std::vector<char>& inbuf, RoomSnapshot& snapshot) {
+    char chunk[RELAY_READ_CHUNK];
+    while (true) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) return false;
+        inbuf.insert(inbuf.end(), chunk, chunk + n);
+    }
+
+    size_t off = 0;
+    while (off < inbuf.size()) {
+        ssize_t len = frame_length(inbuf.data() + off, inbuf.size() - off);
+        if (len < 0) {
+            std::cerr << "[relay] origin 스트림에서 알 수 없는 프레임\n";
+            return false;
+        }
+        if (len == 0) break;
+        snapshot.apply(inbuf.data() + off, len);
+        off += len;
+    }
+    if (off > 0) {
+        fan_out(std::make_shared<std::vector<char>>(inbuf.begin(), inbuf.begin() + off));
+        inbuf.erase(inbuf.begin(), inbuf.begin() + off);
+    }
+    return true;
+}
+
+static void raise_fd_limit() {
+    rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+void run_relay(const RelayOptions& opts) {
+    signal(SIGPIPE, SIG_IGN);
+    raise_fd_limit();
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listen_fd < 0) { perror("socket"); exit(1); }
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(opts.port);
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); exit(1); }
+    if (listen(listen_fd, 1024) < 0) { perror("listen"); exit(1); }
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) { perror("epoll_create1"); exit(1); }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+    std::cout << "[relay] port " << opts.port << "에서 관전자 대기중...\n";
+
+    RoomSnapshot snapshot;
+    std::vector<char> inbuf;
+    int origin_fd = -1;
+    bool had_origin = false;
+    epoll_event events[RELAY_MAX_EVENTS];
+
+    while (true) {
+        if (origin_fd < 0) {
+            origin_fd = connect_origin(opts);
+            if (origin_fd >= 0) {
+                if (had_origin) {
+                    // 재접속: origin이 스냅샷을 다시 보내므로 관전자 화면을 먼저 비운다
+                    DrawPacket clear_pkt{MSG_CLEAR, 0, 0, 0, 0, 0};
+                    fan_out(std::make_shared<std::vector<char>>((char*)&clear_pkt, (char*)&clear_pkt + sizeof(clear_pkt)));
+                }
+                had_origin = true;
+                snapshot.reset();
+                inbuf.clear();
+                ev.events = EPOLLIN | EPOLLRDHUP;
+                ev.data.fd = origin_fd;
+                epoll_ctl(epfd, EPOLL_CTL_ADD, origin_fd, &ev);
+            }
+        }
+
+        int n = epoll_wait(epfd, events, RELAY_MAX_EVENTS, origin_fd < 0 ? RELAY_RECONNECT_MS : -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            uint32_t e = events[i].events;
+
+            if (fd == listen_fd) {
+                int cfd;
+                while ((cfd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+                    int one = 1;
+                    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    Spectator& sp = spectators[cfd];
+                    sp.fd = cfd;
+                    epoll_event cev{};
+                    cev.events = EPOLLIN | EPOLLRDHUP;
+                    cev.data.fd = cfd;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, cfd, &cev);
+                    enqueue(sp, snapshot.build());
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) perror("accept");
+                continue;
+            }
+
+            if (fd == origin_fd) {
+                if (!on_origin_readable(fd, inbuf, snapshot)) {
+                    std::cerr << "[relay] origin 연결 끊김, 재접속 시도\n";
+                    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+                    close(fd);
+                    origin_fd = -1;
+                }
+                continue;
+            }
+
+            auto it = spectators.find(fd);
+            if (it == spectators.end()) continue;
+            if (e & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                // 관전자가 보내는 것(MSG_SPECTATE 등)은 읽어서 버리고 종료만 감지
+                char buf[256];
+                ssize_t r;
+                while ((r = recv(fd, buf, sizeof(buf), 0)) > 0) {}
+                if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    drop_spectator(fd, "연결 종료");
+                    continue;
+                }
+            }
+            if ((e & EPOLLOUT) && !flush_spectator(it->second)) drop_spectator(fd, "send 실패");
+        }
+    }
+    close(listen_fd);
+}
+
+static bool parse_option(const std::string& a, const char* key, std::string& value) {
+    std::string prefix = std::string("--") + key + "=";
+    if (a.compare(0, prefix.size(), prefix) != 0) return false;
+    value = a.substr(prefix.size());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    RelayOptions opts;
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i], v;
+        if (parse_option(a, "origin", v)) {
+            size_t colon = v.rfind(':');
+            opts.origin_host = v.substr(0, colon);
+            if (colon != std::string::npos) opts.origin_port = (unsigned short)std::atoi(v.c_str() + colon + 1);
+        } else if (parse_option(a, "room", v)) {
+            opts.room_id = std::atoi(v.c_str());
+        } else if (parse_option(a, "port", v)) {
+            opts.port = (unsigned short)std::atoi(v.c_str());
+        } else {
+            std::cerr << "unknown option: " << a << '\n';
+            ok = false;
+        }
+    }
+    if (!ok) {
+        std::cerr << "usage: " << argv[0] << " [--origin=HOST:PORT] [--room=N] [--port=N]\n";
+        std::cerr << "예시: ./relay_app --origin=127.0.0.1:" << SERVER_PORT << " --port=" << RELAY_PORT << '\n';
+        std::cerr << "      origin에는 관전자 하나로만 접속하고, 관전자들은 ./client_app watch _ --port=" << RELAY_PORT << '\n';
+        return 1;
+    }
+    run_relay(opts);
+    return 0;
+}
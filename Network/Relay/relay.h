@@ -0,0 +1,49 @@
+#ifndef RELAY_H
+#define RELAY_H
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../Common/protocol.h"
+
+#define RELAY_MAX_QUEUE_BYTES (4 * 1024 * 1024)   // 이보다 밀린 관전자는 끊는다
+#define RELAY_STROKE_MAX_BYTES (8 * 1024 * 1024)  // 늦게 들어온 관전자용 획 기록 한도
+#define RELAY_RECONNECT_MS 1000
+
+using SharedBuf = std::shared_ptr<const std::vector<char>>;
+
+// 관전자 한 명의 송신 큐. 같은 버퍼를 모든 관전자가 공유하고 각자 offset만 가진다
+struct Spectator {
+    int fd;
+    std::deque<std::pair<SharedBuf, size_t>> queue;
+    size_t queued_bytes = 0;
+    bool want_write = false;
+};
+
+// origin 스트림에서 유지하는 상태. 새 관전자에게 이것부터 보낸다
+class RoomSnapshot {
+public:
+    void apply(const char* frame, size_t len);
+    void reset();
+    SharedBuf build() const;
+
+private:
+    std::map<int, std::string> players_;
+    std::vector<char> player_cnt_;
+    std::vector<char> selected_;
+    std::vector<char> strokes_;   // 마지막 clear 이후의 획 프레임
+};
+
+struct RelayOptions {
+    std::string origin_host = "127.0.0.1";
+    unsigned short origin_port = SERVER_PORT;
+    int room_id = -1;                      // >= 0 이면 gateway 경유로 MSG_JOIN_ROOM 먼저 전송
+    unsigned short port = RELAY_PORT;
+};
+
+void run_relay(const RelayOptions& opts);
+
+#endif // RELAY_H
@@ -0,0 +1,46 @@
+#include "alloc_count.h"
+
+#ifdef SERVER_ALLOC_COUNT
+#include <cstdlib>
+#include <new>
+
+// --sim은 한 스레드에서 돌므로 단순 카운터로 충분하다
+static uint64_t allocations = 0;
+static uint64_t scoped_allocations = 0;
+static uint64_t scopes = 0;
+static int paused = 0;
+
+uint64_t message_alloc_count() { return scoped_allocations; }
+uint64_t message_count() { return scopes; }
+
+MessageAllocScope::MessageAllocScope() : start(allocations) {}
+MessageAllocScope::~MessageAllocScope() {
+    scoped_allocations += allocations - start;
+    scopes++;
+}
+
+AllocCountPause::AllocCountPause() { paused++; }
+AllocCountPause::~AllocCountPause() { paused--; }
+
+static void* counted_alloc(size_t n) noexcept {
+    if (paused == 0) allocations++;
+    return std::malloc(n ? n : 1);
+}
+
+void* operator new(size_t n) {
+    void* p = counted_alloc(n);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t n) {
+    void* p = counted_alloc(n);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,34 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <cstdint>
+
+// make alloc_check 빌드(-DSERVER_ALLOC_COUNT)에서만 operator new 호출을 센다
+// 일반 빌드에서는 아래 타입들이 아무 일도 하지 않는다
+#ifdef SERVER_ALLOC_COUNT
+uint64_t message_alloc_count();   // MessageAllocScope 안에서 일어난 할당 합계
+uint64_t message_count();         // MessageAllocScope 수
+
+// 연결 루프에서 메시지 하나를 처리하는 범위. --sim(한 스레드, preempt 0)에서만 정확하다
+struct MessageAllocScope {
+    MessageAllocScope();
+    ~MessageAllocScope();
+    uint64_t start;
+};
+
+// 이 범위의 할당은 세지 않는다 (loopback이 흉내 내는 커널 socket 버퍼처럼 서버 코드가 아닌 쪽)
+struct AllocCountPause {
+    AllocCountPause();
+    ~AllocCountPause();
+};
+#else
+struct MessageAllocScope {
+    MessageAllocScope() {}
+};
+
+struct AllocCountPause {
+    AllocCountPause() {}
+};
+#endif
+
+#endif // ALLOC_COUNT_H
@@ -0,0 +1,173 @@
+#include "loopback.h"
+#include "alloc_count.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+
+// ---------------- FiberScheduler ----------------
+FiberScheduler::~FiberScheduler() {
+    for (Fiber* f : fibers_) {
+        if (f->stack) munmap(f->stack, FIBER_STACK_SIZE);
+        delete f;
+    }
+}
+
+void FiberScheduler::trampoline(unsigned lo, unsigned hi) {
+    FiberScheduler* self = reinterpret_cast<FiberScheduler*>(((uintptr_t)hi << 32) | lo);
+    Fiber* f = self->fibers_[self->current_];
+    f->fn();
+    f->done = true;
+    f->fn = nullptr;   // 캡처한 상태를 여기서 정리
+    // uc_link로 run()에 돌아간다
+}
+
+void FiberScheduler::spawn(std::function<void()> fn) {
+    Fiber* f = new Fiber;
+    f->fn = std::move(fn);
+    // 건드린 page만 실제 메모리를 쓴다 (가상 클라이언트 수천 개)
+    f->stack = mmap(nullptr, FIBER_STACK_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (f->stack == MAP_FAILED) {
+        perror("mmap(fiber stack)");
+        exit(1);
+    }
+    getcontext(&f->ctx);
+    f->ctx.uc_stack.ss_sp = f->stack;
+    f->ctx.uc_stack.ss_size = FIBER_STACK_SIZE;
+    f->ctx.uc_link = &main_ctx_;
+    uintptr_t self = reinterpret_cast<uintptr_t>(this);
+    makecontext(&f->ctx, (void (*)())trampoline, 2, (unsigned)(self & 0xffffffffu), (unsigned)(self >> 32));
+    fibers_.push_back(f);
+    f->ready = true;
+    ready_.push_back(fibers_.size() - 1);
+}
+
+size_t FiberScheduler::run() {
+    while (!ready_.empty()) {
+        size_t pick = std::uniform_int_distribution<size_t>(0, ready_.size() - 1)(rng_);
+        int id = ready_[pick];
+        ready_[pick] = ready_.back();
+        ready_.pop_back();
+
+        Fiber* f = fibers_[id];
+        f->ready = false;
+        current_ = id;
+        switches_++;
+        trace_hash_ = (trace_hash_ ^ (uint64_t)id) * 1099511628211ull;
+        swapcontext(&main_ctx_, &f->ctx);
+        current_ = -1;
+
+        if (f->done && f->stack) {
+            munmap(f->stack, FIBER_STACK_SIZE);
+            f->stack = nullptr;
+        }
+    }
+    return std::count_if(fibers_.begin(), fibers_.end(), [](const Fiber* f) { return !f->done; });
+}
+
+void FiberScheduler::yield() {
+    Fiber* f = fibers_[current_];
+    f->ready = true;
+    ready_.push_back(current_);
+    swapcontext(&f->ctx, &main_ctx_);
+}
+
+void FiberScheduler::block() {
+    swapcontext(&fibers_[current_]->ctx, &main_ctx_);
+}
+
+void FiberScheduler::wake(int fiber) {
+    if (fiber < 0) return;
+    Fiber* f = fibers_[fiber];
+    if (f->ready || f->done || fiber == current_) return;
+    f->ready = true;
+    ready_.push_back(fiber);
+}
+
+// ---------------- LoopbackNet ----------------
+std::pair<int, int> LoopbackNet::connect() {
+    int a = LOOPBACK_FD_BASE + eps_.size();
+    int b = a + 1;
+    eps_.emplace_back();
+    eps_.emplace_back();
+    eps_[a - LOOPBACK_FD_BASE].peer = b;
+    eps_[b - LOOPBACK_FD_BASE].peer = a;
+    return {a, b};
+}
+
+LoopbackNet::Endpoint* LoopbackNet::endpoint(int fd) {
+    size_t idx = fd - LOOPBACK_FD_BASE;
+    if (fd < LOOPBACK_FD_BASE || idx >= eps_.size()) return nullptr;
+    return &eps_[idx];
+}
+
+void LoopbackNet::maybe_preempt() {
+    if (preempt_ > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < preempt_)
+        sched_.yield();
+}
+
+ssize_t LoopbackNet::recv(int fd, void* buf, size_t len, int flags) {
+    maybe_preempt();
+    while (true) {
+        Endpoint* ep = endpoint(fd);
+        if (ep == nullptr || ep->closed) {
+            errno = EBADF;
+            return -1;
+        }
+        size_t avail = ep->rx.size() - ep->rx_off;
+        size_t need = (flags & MSG_WAITALL) ? len : std::min<size_t>(len, 1);
+        if (avail >= need || (avail > 0 && !(flags & MSG_WAITALL)) || ep->peer_closed) {
+            size_t n = std::min(len, avail);
+            std::memcpy(buf, ep->rx.data() + ep->rx_off, n);
+            if (!(flags & MSG_PEEK)) {
+                ep->rx_off += n;
+                if (ep->rx_off == ep->rx.size()) {
+                    ep->rx.clear();
+                    ep->rx_off = 0;
+                }
+            }
+            return n;
+        }
+        if (flags & MSG_DONTWAIT) {
+            errno = EAGAIN;
+            return -1;
+        }
+        ep->waiter = sched_.current();
+        sched_.block();
+    }
+}
+
+bool LoopbackNet::wait_readable(int fd) {
+    while (true) {
+        Endpoint* ep = endpoint(fd);
+        if (ep == nullptr || ep->closed || ep->peer_closed || ep->rx.size() > ep->rx_off) return true;
+        ep->waiter = sched_.current();
+        sched_.block();
+    }
+}
+
+void LoopbackNet::send(int fd, const void* buf, size_t len) {
+    AllocCountPause pause;   // 수신 버퍼가 자라는 것은 커널 쪽 비용
+    Endpoint* ep = endpoint(fd);
+    if (ep == nullptr || ep->closed || ep->peer_closed) return;
+    Endpoint& peer = eps_[ep->peer - LOOPBACK_FD_BASE];
+    const char* p = static_cast<const char*>(buf);
+    peer.rx.insert(peer.rx.end(), p, p + len);
+    bytes_sent_ += len;
+    sched_.wake(peer.waiter);
+    peer.waiter = -1;
+}
+
+void LoopbackNet::close(int fd) {
+    Endpoint* ep = endpoint(fd);
+    if (ep == nullptr || ep->closed) return;
+    ep->closed = true;
+    std::vector<char>().swap(ep->rx);
+    ep->rx_off = 0;
+    Endpoint& peer = eps_[ep->peer - LOOPBACK_FD_BASE];
+    peer.peer_closed = true;
+    sched_.wake(peer.waiter);
+    peer.waiter = -1;
+}
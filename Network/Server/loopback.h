@@ -0,0 +1,107 @@
+#ifndef LOOPBACK_H
+#define LOOPBACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+#include <ucontext.h>
+#include "transport.h"
+#include "net_backend.h"
+
+#define FIBER_STACK_SIZE (128 * 1024)
+#define LOOPBACK_FD_BASE 100000   // 실제 fd와 섞이지 않도록 가상 fd는 여기서부터
+
+// 한 스레드 안에서 도는 협력형 fiber. 실행할 fiber는 seed 고정 난수로 고르므로
+// 같은 seed면 같은 interleaving이 재현된다
+class FiberScheduler {
+public:
+    explicit FiberScheduler(uint32_t seed) : rng_(seed) {}
+    ~FiberScheduler();
+
+    void spawn(std::function<void()> fn);
+    // ready fiber가 없을 때까지 실행. 끝나지 않고 block된 fiber 수를 돌려준다 (0이 아니면 교착)
+    size_t run();
+
+    // fiber 안에서만 호출
+    void yield();                // ready 상태로 남고 다른 fiber에게 양보
+    void block();                // wake될 때까지 잠든다
+    int current() const { return current_; }
+    void wake(int fiber);
+
+    uint64_t switches() const { return switches_; }
+    uint64_t trace_hash() const { return trace_hash_; }   // 실행 순서 hash
+
+private:
+    struct Fiber {
+        ucontext_t ctx;
+        std::function<void()> fn;
+        void* stack = nullptr;
+        bool ready = false;
+        bool done = false;
+    };
+    static void trampoline(unsigned lo, unsigned hi);
+
+    std::vector<Fiber*> fibers_;
+    std::vector<int> ready_;
+    ucontext_t main_ctx_;
+    int current_ = -1;
+    std::mt19937 rng_;
+    uint64_t switches_ = 0;
+    uint64_t trace_hash_ = 1469598103934665603ull;
+};
+
+// 메모리 안의 양방향 byte stream. recv가 데이터를 기다려야 하면 현재 fiber를 block한다
+// preempt > 0 이면 데이터가 있어도 그 확률로 양보해서 interleaving을 더 흔든다
+class LoopbackNet : public Transport {
+public:
+    LoopbackNet(FiberScheduler& sched, double preempt, uint32_t seed)
+        : sched_(sched), preempt_(preempt), rng_(seed) {}
+
+    // 연결 하나 생성: (서버 쪽 fd, 클라이언트 쪽 fd)
+    std::pair<int, int> connect();
+
+    ssize_t recv(int fd, void* buf, size_t len, int flags) override;
+    bool wait_readable(int fd) override;
+    void close_after_send(int fd) override { close(fd); }
+    void close(int fd) override;
+    // 닫혔거나 상대가 닫은 연결에는 버린다 (EPIPE 대신)
+    void send(int fd, const void* buf, size_t len);
+
+    uint64_t bytes_sent() const { return bytes_sent_; }
+
+private:
+    struct Endpoint {
+        std::vector<char> rx;
+        size_t rx_off = 0;
+        int peer = -1;
+        int waiter = -1;           // recv에서 잠든 fiber
+        bool closed = false;
+        bool peer_closed = false;
+    };
+    Endpoint* endpoint(int fd);
+    void maybe_preempt();
+
+    FiberScheduler& sched_;
+    double preempt_;
+    std::mt19937 rng_;
+    std::vector<Endpoint> eps_;
+    uint64_t bytes_sent_ = 0;
+};
+
+// LoopbackNet을 서버 송신 경로(NetBackend)로 쓰기 위한 adapter
+class LoopbackBackend : public NetBackend {
+public:
+    explicit LoopbackBackend(LoopbackNet& net) : net_(net) {}
+    const char* name() const override { return "loopback"; }
+    void send_one(int fd, const void* buf, size_t len) override { net_.send(fd, buf, len); }
+    void send_to_all(const int* fds, size_t n, const void* buf, size_t len) override {
+        for (size_t i = 0; i < n; ++i) net_.send(fds[i], buf, len);
+    }
+
+private:
+    LoopbackNet& net_;
+};
+
+#endif // LOOPBACK_H
@@ -1,140 +1,655 @@
 #include "server.h"
+#include "stroke_simplify.h"
+#include "net_backend.h"
+#include "upgrade.h"
+#include "transport.h"
+#include "loopback.h"
+#include "simulation.h"
+#include "alloc_count.h"
+#include "../Common/frame_pool.h"
+#include "../Common/loss_sim.h"
+#include "../Common/frame_codec.h"
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
 #include <algorithm>
 #include <cstring>
 #include <netinet/in.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <random>
+#include <csignal>
+#include <cerrno>
+#include <string_view>
+
+// 송신은 net_backend, 수신은 transport를 거친다 (실제 socket 또는 시뮬레이션용 loopback)
+std::unique_ptr<NetBackend> net_backend;
+std::unique_ptr<Transport> transport;
 
 void send_string(int fd, const std::string& s) {
     uint32_t len = s.size();
-    send(fd, &len, sizeof(len), 0);
-    if (len > 0) send(fd, s.data(), len, 0);
+    net_backend->send_one(fd, &len, sizeof(len));
+    if (len > 0) net_backend->send_one(fd, s.data(), len);
+}
+
+// len 바이트를 읽어서 버린다 (스트림 동기를 유지하면서 너무 긴 문자열을 거절할 때)
+static bool discard_bytes(int fd, size_t len) {
+    char buf[256];
+    while (len > 0) {
+        size_t chunk = std::min(len, sizeof(buf));
+        if (transport->recv(fd, buf, chunk, MSG_WAITALL) != (ssize_t)chunk) return false;
+        len -= chunk;
+    }
+    return true;
 }
 
-std::string recv_string(int fd) {
+// 길이 prefix 문자열을 연결 arena에 읽는다 (steady state에서 힙 할당 없음)
+// 길이가 MAX_MESSAGE_LEN을 넘거나 arena가 부족하면 내용은 읽어 버리고 too_long을 세운다
+// 연결이 끊기면 false
+bool recv_string_view(int fd, ConnArena& arena, std::string_view& out, bool& too_long) {
     uint32_t len = 0;
-    recv(fd, &len, sizeof(len), MSG_WAITALL);
-    std::string s;
-    if (len > 0) {
-        s.resize(len);
-        recv(fd, &s[0], len, MSG_WAITALL);
+    if (transport->recv(fd, &len, sizeof(len), MSG_WAITALL) != sizeof(len)) return false;
+    char* p = len <= MAX_MESSAGE_LEN ? arena.alloc(len) : nullptr;
+    if (p == nullptr) {
+        too_long = true;
+        out = std::string_view();
+        return discard_bytes(fd, len);
     }
-    return s;
+    if (len > 0 && transport->recv(fd, p, len, MSG_WAITALL) != (ssize_t)len) return false;
+    out = std::string_view(p, len);
+    return true;
 }
 
 struct ClientInfo {
-    int fd;
+    int fd = -1;
+    int player_id = -1;
     std::string nickname;
+    int score = 0;          // 맞힌 횟수 (재시작 시 상태 파일로 넘어간다)
+    // 수신자별 획 단순화 상태 (송신자가 바뀌면 초기화)
+    int lod_sender_fd = -1;
+    StrokeSimplifier simplifier{};
+    // UDP 획 채널 (MSG_UDP_REQUEST로 협상, hello datagram으로 주소 등록)
+    uint32_t udp_token = 0;
+    bool udp_ready = false;
+    sockaddr_in udp_addr{};
 };
 
 std::mutex clients_mutex;
 std::vector<ClientInfo> clients;
 std::string current_answer;
+ServerOptions server_opts;
+FramePool frame_pool;
+unsigned short server_port = SERVER_PORT;
+int udp_fd = -1;
+LossSim udp_loss;          // udp_relay_thread 전용
+
+// 관전자 (인원 제한 없음, 읽기 전용). clients_mutex로 보호
+std::vector<int> spectators;
+// 늦게 들어온 관전자/relay용 상태: 마지막 clear 이후의 획 프레임과 현재 출제자
+#define STROKE_LOG_MAX_BYTES (8 * 1024 * 1024)
+std::vector<char> stroke_log;
+int selected_player = -1;
+std::mt19937 game_rng{std::random_device{}()};   // 출제자 선택 (시뮬레이션에서는 seed 고정)
+
+// accept 루프 상태 (재시작 시 상태 파일로 넘어간다)
+int player_counter = 1;
+bool is_first_client = true;
+std::mutex is_first_client_mutex;
+
+// 무중단 재시작: upgrade_efd가 set되면 연결 스레드는 다음 메시지 경계에서 연결을 닫지 않고 빠진다
+int upgrade_efd = -1;
+std::mutex session_mutex;
+std::condition_variable session_cv;
+int active_sessions = 0;
+bool upgrade_parking = false;      // 인수 진행 중. session_mutex로 보호
+std::vector<int> parked_fds;       // 이번 인수에서 실제로 멈춘 연결 (취소 시 이것만 되살린다)
+
+// 입장 처리 중(clients/spectators에 들어가기 전)인 연결. clients_mutex로 보호
+// 중간까지 읽은 handshake는 넘길 수 없으므로 인수 시에는 끊는다
+std::vector<int> joining_fds;
 
 // 구조체 패킷 전송/수신
-void send_drawpacket(int fd, const DrawPacket& pkt) {
-    send(fd, &pkt, sizeof(pkt), 0);
-}
 bool recv_drawpacket(int fd, DrawPacket& pkt) {
-    return recv(fd, &pkt, sizeof(pkt), MSG_WAITALL) == sizeof(pkt);
+    return transport->recv(fd, &pkt, sizeof(pkt), MSG_WAITALL) == sizeof(pkt);
 }
-void send_answerpacket(int fd, const AnswerPacket& pkt) {
-    send(fd, &pkt.type, sizeof(pkt.type), 0);
-    send_string(fd, pkt.nickname);
-    send_string(fd, pkt.answer);
-}
-bool recv_answerpacket(int fd, AnswerPacket& pkt) {
-    int header;
-    if (recv(fd, &header, sizeof(header), MSG_WAITALL) != sizeof(header)) return false;
-    pkt.type = header;
-    pkt.nickname = recv_string(fd);
-    pkt.answer = recv_string(fd);
+// MSG_DRAW_BATCH는 header + 점 배열을 그대로 한 덩어리로 relay한다
+bool recv_drawbatch(int fd, char* buf, size_t& len) {
+    DrawBatchHeader hdr;
+    if (transport->recv(fd, &hdr, sizeof(hdr), MSG_WAITALL) != sizeof(hdr)) return false;
+    if (hdr.count < 0 || hdr.count > MAX_DRAW_BATCH) return false;
+    std::memcpy(buf, &hdr, sizeof(hdr));
+    ssize_t plen = hdr.count * sizeof(DrawPoint);
+    if (plen > 0 && transport->recv(fd, buf + sizeof(hdr), plen, MSG_WAITALL) != plen) return false;
+    len = sizeof(hdr) + plen;
     return true;
 }
-void send_correctpacket(int fd, const CorrectPacket& pkt) {
-    send(fd, &pkt.type, sizeof(pkt.type), 0);
-    send_string(fd, pkt.nickname);
-}
-void send_wrongpacket(int fd, const WrongPacket& pkt) {
-    send(fd, &pkt.type, sizeof(pkt.type), 0);
-    send_string(fd, pkt.nickname);
-    send_string(fd, pkt.message);
+// AnswerPacket을 std::string 없이 arena 위의 view로 디코딩
+bool recv_answerpacket(int fd, ConnArena& arena, std::string_view& nickname, std::string_view& answer,
+                       bool& too_long) {
+    int header;
+    if (transport->recv(fd, &header, sizeof(header), MSG_WAITALL) != sizeof(header)) return false;
+    return recv_string_view(fd, arena, nickname, too_long) && recv_string_view(fd, arena, answer, too_long);
 }
 
 void send_commonpacket(int fd, const CommonPacket& pkt) {
-    send(fd, &pkt.type, sizeof(pkt.type), 0);
-    send_string(fd, pkt.nickname);
+    int header[2] = { pkt.type, pkt.player_id };
+    net_backend->send_one(fd, header, sizeof(header));
     send_string(fd, pkt.message);
 }
 
-void broadcast_draw(const DrawPacket& pkt, int except_fd = -1) {
-    std::lock_guard<std::mutex> lock(clients_mutex);
+// 입장한 클라이언트에게 현재 인원 전체 목록을 1회 전송 (clients_mutex 보유 상태에서 호출)
+void send_player_table(int fd) {
+    PlayerTableHeader hdr{MSG_PLAYER_TABLE, (int)clients.size()};
+    net_backend->send_one(fd, &hdr, sizeof(hdr));
+    for (const auto& client : clients) {
+        net_backend->send_one(fd, &client.player_id, sizeof(client.player_id));
+        send_string(fd, client.nickname);
+    }
+}
+
+// 획 프레임을 stroke_log에 추가 (clients_mutex 보유 상태). 한도를 넘으면 더 쌓지 않는다
+static void log_stroke_frame_locked(const void* buf, size_t len) {
+    if (stroke_log.size() + len > STROKE_LOG_MAX_BYTES) return;
+    const char* p = static_cast<const char*>(buf);
+    stroke_log.insert(stroke_log.end(), p, p + len);
+}
+
+static void send_to_spectators_locked(const void* buf, size_t len) {
+    if (!spectators.empty())
+        net_backend->send_to_all(spectators.data(), spectators.size(), buf, len);
+}
+
+// 같은 바이트를 except_fd를 제외한 모든 클라이언트와 관전자에게 (clients_mutex 보유 상태에서 호출)
+static void broadcast_frame_locked(const void* buf, size_t len, int except_fd = -1) {
+    int fds[MAX_CLIENTS * 4];
+    size_t n = 0;
     for (const auto& client : clients) {
         if (client.fd == except_fd) continue;
-        send_drawpacket(client.fd, pkt);
+        if (n == sizeof(fds) / sizeof(fds[0])) {
+            net_backend->send_to_all(fds, n, buf, len);
+            n = 0;
+        }
+        fds[n++] = client.fd;
     }
+    net_backend->send_to_all(fds, n, buf, len);
+    send_to_spectators_locked(buf, len);
 }
-void broadcast_correct(const CorrectPacket& pkt) {
+
+void broadcast_frame(const void* buf, size_t len, int except_fd = -1) {
     std::lock_guard<std::mutex> lock(clients_mutex);
-    for (const auto& client : clients)
-        send_correctpacket(client.fd, pkt);
+    broadcast_frame_locked(buf, len, except_fd);
 }
 
-void broadcast_common(const CommonPacket& pkt) {
+void broadcast_draw(const DrawPacket& pkt, int except_fd = -1) {
     std::lock_guard<std::mutex> lock(clients_mutex);
-    for (const auto& client : clients)
-        send_commonpacket(client.fd, pkt);
+    if (pkt.type == MSG_CLEAR) {
+        for (auto& client : clients) client.simplifier.reset();
+        stroke_log.clear();
+    } else {
+        log_stroke_frame_locked(&pkt, sizeof(pkt));
+    }
+    broadcast_frame_locked(&pkt, sizeof(pkt), except_fd);
 }
 
-void broadcast_playerCnt(const PlayerCntPacket& pkt) {
+// 단순화 결과는 앞 배치에서 붙잡고 있던 점까지 더해져 MAX_DRAW_BATCH를 넘을 수 있으므로
+// MAX_DRAW_BATCH개씩 나눠서 보낸다. pts 바로 앞에 header 자리가 있어야 한다
+// (다음 조각의 header는 이미 보낸 앞 조각의 끝에 덮어쓴다. send_one은 전송을 마치고 돌아온다)
+static void send_points_as_batches(int fd, DrawPoint* pts, int n) {
+    for (int off = 0; off < n; off += MAX_DRAW_BATCH) {
+        int cnt = std::min(n - off, MAX_DRAW_BATCH);
+        char* frame = reinterpret_cast<char*>(pts + off) - sizeof(DrawBatchHeader);
+        DrawBatchHeader hdr{MSG_DRAW_BATCH, cnt};
+        std::memcpy(frame, &hdr, sizeof(hdr));
+        net_backend->send_one(fd, frame, sizeof(hdr) + cnt * sizeof(DrawPoint));
+    }
+}
+
+// 수신자의 송신 큐 적체에 맞춰 점을 줄여서 보낸다. 적체가 없으면 원본 그대로
+static void send_drawbatch_lod(ClientInfo& client, const char* buf, int sender_fd) {
+    if (client.lod_sender_fd != sender_fd) {
+        client.simplifier.reset();
+        client.lod_sender_fd = sender_fd;
+    }
+    float tol = simplify_tolerance_for_backlog(socket_send_backlog(client.fd), server_opts.simplify_tol);
+
+    const DrawBatchHeader* hdr = reinterpret_cast<const DrawBatchHeader*>(buf);
+    const DrawPoint* in = reinterpret_cast<const DrawPoint*>(buf + sizeof(DrawBatchHeader));
+    char out_buf[sizeof(DrawBatchHeader) + 2 * MAX_DRAW_BATCH * sizeof(DrawPoint)];
+    DrawPoint* out = reinterpret_cast<DrawPoint*>(out_buf + sizeof(DrawBatchHeader));
+    uint64_t now = monotonic_us();
+    int n = 0;
+    for (int i = 0; i < hdr->count; ++i)
+        n += client.simplifier.push(in[i], tol, now, out + n);
+    n += client.simplifier.flush_stale(now, out + n);
+    send_points_as_batches(client.fd, out, n);
+}
+
+// 펜이 멈추면 StrokeBatcher가 점을 보내지 않아 배치 끝 flush가 돌지 않는다.
+// 서버 타이머로 붙잡은 점을 SIMPLIFY_MAX_HOLD_US 안에 내보낸다
+void simplify_flush_thread() {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd < 0) { perror("timerfd_create"); return; }
+    itimerspec its{};
+    its.it_value.tv_nsec = SIMPLIFY_FLUSH_INTERVAL_US * 1000;
+    its.it_interval.tv_nsec = SIMPLIFY_FLUSH_INTERVAL_US * 1000;
+    timerfd_settime(tfd, 0, &its, nullptr);
+    while (true) {
+        uint64_t expirations;
+        if (read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            if (errno == EINTR) continue;
+            perror("read(timerfd)");
+            break;
+        }
+        uint64_t now = monotonic_us();
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for (auto& client : clients) {
+            char buf[sizeof(DrawBatchHeader) + sizeof(DrawPoint)];
+            DrawPoint* out = reinterpret_cast<DrawPoint*>(buf + sizeof(DrawBatchHeader));
+            send_points_as_batches(client.fd, out, client.simplifier.flush_stale(now, out));
+        }
+    }
+    close(tfd);
+}
+
+void broadcast_drawbatch(const char* buf, size_t len, int except_fd = -1) {
     std::lock_guard<std::mutex> lock(clients_mutex);
-    for (const auto& client : clients)
-        send(client.fd, &pkt, sizeof(pkt), 0);
+    log_stroke_frame_locked(buf, len);
+    if (server_opts.simplify_tol <= 0.0f) {
+        broadcast_frame_locked(buf, len, except_fd);
+        return;
+    }
+    for (auto& client : clients) {
+        if (client.fd == except_fd) continue;
+        send_drawbatch_lod(client, buf, except_fd);
+    }
+    send_to_spectators_locked(buf, len);   // 관전자(relay)는 항상 원본
+}
+
+// CommonPacket(type, player_id, message)을 풀 프레임에 한 번만 인코딩해서 모두에게 전송
+void broadcast_common(int type, int player_id, std::string_view message) {
+    PooledFrame frame(frame_pool);
+    int header[2] = { type, player_id };
+    frame->append(header, sizeof(header));
+    if (!frame->append_string(message)) return;
+    broadcast_frame(frame->data, frame->len);
 }
 
-void broadcast_selected_player(const std::string& nickname) {
+// 요청한 클라이언트 한 명에게만 오류를 알린다 (CommonPacket 형식)
+void send_error(int fd, int player_id, std::string_view message) {
+    PooledFrame frame(frame_pool);
+    int header[2] = { MSG_ERROR, player_id };
+    frame->append(header, sizeof(header));
+    if (!frame->append_string(message)) return;
+    net_backend->send_one(fd, frame->data, frame->len);
+}
+
+void broadcast_playerCnt(const PlayerCntPacket& pkt) {
+    broadcast_frame(&pkt, sizeof(pkt));
+}
+
+void broadcast_selected_player(int player_id) {
     SelectedPlayerPacket pkt;
     pkt.type = MSG_SELECTED_PLAYER;
-    pkt.nickname = nickname;
+    pkt.player_id = player_id;
     std::lock_guard<std::mutex> lock(clients_mutex);
-    for (const auto& client : clients) {
-        // Packet 전송
-        send(client.fd, &pkt.type, sizeof(pkt.type), 0);
-        send_string(client.fd, pkt.nickname);
-    }
+    selected_player = player_id;
+    broadcast_frame_locked(&pkt, sizeof(pkt));
 }
 
-    std::string pick_random_player() {
+// 새 플레이어 입장: 본인에게는 전체 테이블, 나머지에게는 delta만
+void announce_player_join(int fd, int player_id, const std::string& nickname) {
+    PooledFrame frame(frame_pool);
+    int header[2] = { MSG_PLAYER_JOIN, player_id };
+    frame->append(header, sizeof(header));
+    frame->append_string(nickname);
+
     std::lock_guard<std::mutex> lock(clients_mutex);
-    if (clients.empty()) return "";
+    send_player_table(fd);
+    broadcast_frame_locked(frame->data, frame->len, fd);
+}
+
+void broadcast_player_leave(int player_id) {
+    PlayerLeavePacket pkt{MSG_PLAYER_LEAVE, player_id};
+    broadcast_frame(&pkt, sizeof(pkt));
+}
+
+// header + 점 배열을 buf에 읽는다 (TCP MSG_STROKE_SEGMENT)
+bool recv_strokesegment(int fd, char* buf, size_t& len) {
+    StrokeSegmentHeader hdr;
+    if (transport->recv(fd, &hdr, sizeof(hdr), MSG_WAITALL) != sizeof(hdr)) return false;
+    if (hdr.count < 0 || hdr.count > MAX_STROKE_SEGMENT) return false;
+    std::memcpy(buf, &hdr, sizeof(hdr));
+    ssize_t plen = hdr.count * sizeof(DrawPoint);
+    if (plen > 0 && transport->recv(fd, buf + sizeof(hdr), plen, MSG_WAITALL) != plen) return false;
+    len = sizeof(hdr) + plen;
+    return true;
+}
+
+// 클라이언트 요청 시 UDP 채널 제안. UDP 소켓이 없으면 응답하지 않고 TCP만 사용
+void offer_udp(int client_fd, unsigned short udp_port) {
+    if (udp_fd < 0) return;
     static std::random_device rd;
-    static std::mt19937 gen(rd());
+    uint32_t token = 0;
+    while (token == 0) token = rd();
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for (auto& client : clients) {
+            if (client.fd != client_fd) continue;
+            client.udp_token = token;
+            client.udp_ready = false;
+        }
+    }
+    UdpOfferPacket offer{MSG_UDP_OFFER, udp_port, token};
+    net_backend->send_one(client_fd, &offer, sizeof(offer));
+}
+
+// UDP 실시간 점 relay. UDP 주소가 등록된 수신자에게는 UDP로(손실 시뮬레이션 적용),
+// 나머지에게는 같은 segment를 TCP로 보낸다. 빠진 점은 그린 쪽의 TCP sync가 채운다
+void udp_relay_thread() {
+    char buf[sizeof(StrokeSegmentHeader) + MAX_STROKE_SEGMENT * sizeof(DrawPoint)];
+    while (true) {
+        sockaddr_in from{};
+        socklen_t from_len = sizeof(from);
+        ssize_t n = recvfrom(udp_fd, buf, sizeof(buf), 0, (sockaddr*)&from, &from_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("recvfrom(udp)");
+            return;
+        }
+        if (n < (ssize_t)sizeof(StrokeSegmentHeader)) continue;
+        StrokeSegmentHeader* hdr = reinterpret_cast<StrokeSegmentHeader*>(buf);
+        if (hdr->type != MSG_STROKE_SEGMENT || hdr->token == 0 || hdr->count < 0 || hdr->count > MAX_STROKE_SEGMENT
+            || (size_t)n != sizeof(StrokeSegmentHeader) + hdr->count * sizeof(DrawPoint)
+            || !stroke_seq_in_range(*hdr))
+            continue;
+
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        auto sender = std::find_if(clients.begin(), clients.end(),
+            [hdr](const ClientInfo& c) { return c.udp_token == hdr->token; });
+        if (sender == clients.end()) continue;
+        sender->udp_addr = from;   // hello 또는 주소 변경
+        sender->udp_ready = true;
+        if (hdr->count == 0) continue;
+
+        hdr->token = 0;
+        hdr->player_id = sender->player_id;
+        hdr->flags = SEGMENT_LIVE;
+        for (const auto& client : clients) {
+            if (client.fd == sender->fd) continue;
+            if (client.udp_ready) {
+                const sockaddr_in& to = client.udp_addr;
+                udp_loss.send(buf, n, [&to](const void* p, size_t len) {
+                    sendto(udp_fd, p, len, 0, (const sockaddr*)&to, sizeof(to));
+                });
+            } else {
+                net_backend->send_one(client.fd, buf, n);
+            }
+        }
+        send_to_spectators_locked(buf, n);
+    }
+}
+
+// 출제자 선택. 플레이어가 없으면 -1
+int pick_random_player() {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    if (clients.empty()) return -1;
     std::uniform_int_distribution<> dis(0, clients.size() - 1);
-    return clients[dis(gen)].nickname;
+    return clients[dis(game_rng)].player_id;
 }
 
-void handle_client(int client_fd, int player_num, bool is_first_client) {
+// 관전자에게 현재 상태를 보낸다 (clients_mutex 보유 상태)
+static void send_snapshot_locked(int fd) {
+    send_player_table(fd);
+    PlayerCntPacket cnt_pkt{MSG_PLAYER_CNT, current_Player, max_Player};
+    net_backend->send_one(fd, &cnt_pkt, sizeof(cnt_pkt));
+    if (selected_player >= 0) {
+        SelectedPlayerPacket sel_pkt{MSG_SELECTED_PLAYER, selected_player};
+        net_backend->send_one(fd, &sel_pkt, sizeof(sel_pkt));
+    }
+    // 프레임 경계를 지키며 나눠서 전송
+    size_t off = 0;
+    while (off < stroke_log.size()) {
+        size_t chunk = 0;
+        while (off + chunk < stroke_log.size() && chunk < FRAME_SIZE * 32) {
+            ssize_t len = frame_length(stroke_log.data() + off + chunk, stroke_log.size() - off - chunk);
+            if (len <= 0) break;
+            chunk += len;
+        }
+        if (chunk == 0) break;
+        net_backend->send_one(fd, stroke_log.data() + off, chunk);
+        off += chunk;
+    }
+}
+
+// 연결 스레드 수 (재시작 시 모두 빠질 때까지 기다린다)
+static void session_enter() {
+    std::lock_guard<std::mutex> lock(session_mutex);
+    active_sessions++;
+}
+
+static void session_exit() {
+    std::lock_guard<std::mutex> lock(session_mutex);
+    active_sessions--;
+    session_cv.notify_all();
+}
+
+// wait_readable이 재시작 신호로 깨어났을 때. 멈췄으면 true, 그 사이 인수가 취소됐으면 false (계속 서비스)
+static bool session_park(int fd) {
+    std::lock_guard<std::mutex> lock(session_mutex);
+    if (!upgrade_parking) return false;
+    parked_fds.push_back(fd);
+    active_sessions--;
+    session_cv.notify_all();
+    return true;
+}
+
+// 입장 처리가 끝나 clients/spectators로 옮겨 갈 때 (clients_mutex 보유 상태)
+static void joining_done_locked(int fd) {
+    joining_fds.erase(std::remove(joining_fds.begin(), joining_fds.end(), fd), joining_fds.end());
+}
+
+// 입장 도중 거절/실패한 연결을 닫는다. 닫은 fd 번호가 재사용되기 전에 목록에서 먼저 뺀다
+static void close_joining(int fd, bool after_send) {
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        joining_done_locked(fd);
+    }
+    if (after_send) transport->close_after_send(fd);
+    else transport->close(fd);
+}
+
+// 관전자 세션: 보내는 것은 무시하고 연결 종료만 감지한다
+static void spectator_session(int fd) {
+    session_enter();
+    char buf[256];
+    while (true) {
+        if (!transport->wait_readable(fd)) {
+            if (session_park(fd)) return;
+            continue;
+        }
+        if (transport->recv(fd, buf, sizeof(buf), 0) <= 0) break;
+    }
+    session_exit();
+
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        spectators.erase(std::remove(spectators.begin(), spectators.end(), fd), spectators.end());
+    }
+    net_backend->remove_connection(fd);
+    transport->close(fd);
+    std::cout << "[Server] spectator disconnected\n";
+}
+
+// 읽기 전용 관전자: 인원 제한/플레이어 목록에 포함되지 않고 broadcast만 받는다
+void handle_spectator(int fd) {
+    SpectatePacket pkt;
+    if (transport->recv(fd, &pkt, sizeof(pkt), MSG_WAITALL) != sizeof(pkt)) {
+        close_joining(fd, false);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        joining_done_locked(fd);
+        net_backend->add_connection(fd);
+        send_snapshot_locked(fd);
+        spectators.push_back(fd);
+    }
+    std::cout << "[Server] spectator connected\n";
+    spectator_session(fd);
+}
+
+// 플레이어 메시지 루프. 입장 처리가 끝난 연결, 또는 재시작으로 넘겨받은 연결에서 시작한다
+static void client_session(int client_fd, int player_num, const std::string& nickname) {
+    session_enter();
+    ConnArena arena;   // 이 연결의 메시지 디코딩용 scratch
+    bool correct = false;
+    while (true) {
+        if (!transport->wait_readable(client_fd)) {
+            if (session_park(client_fd)) return;
+            continue;
+        }
+        MessageAllocScope alloc_scope;   // make alloc_check에서만 센다
+        int msg_type = 0;
+        ssize_t n = transport->recv(client_fd, &msg_type, sizeof(int), MSG_PEEK);
+        if (n <= 0) break;
+
+        if (msg_type == MSG_DRAW || msg_type == MSG_CLEAR) {
+            // MSG_CLEAR는 DrawPacket과 같은 크기로 전송된다 (type만 다름)
+            DrawPacket pkt;
+            if (!recv_drawpacket(client_fd, pkt)) break;
+            broadcast_draw(pkt, client_fd);
+        } else if (msg_type == MSG_DRAW_BATCH) {
+            char buf[sizeof(DrawBatchHeader) + MAX_DRAW_BATCH * sizeof(DrawPoint)];
+            size_t len = 0;
+            if (!recv_drawbatch(client_fd, buf, len)) break;
+            broadcast_drawbatch(buf, len, client_fd);
+        } else if (msg_type == MSG_ANSWER) {
+            arena.reset();
+            std::string_view answer_nickname, answer;
+            bool too_long = false;
+            if (!recv_answerpacket(client_fd, arena, answer_nickname, answer, too_long)) break;
+            if (too_long) {
+                // 연결은 유지하고 보낸 사람에게만 거절을 알린다
+                std::cout << "[Server] answer from " << nickname << " rejected: longer than "
+                          << MAX_MESSAGE_LEN << " bytes\n";
+                send_error(client_fd, player_num, "정답이 너무 깁니다");
+            } else {
+                std::cout << "[Received answer] " << nickname << ": " << answer << std::endl;
+                if (answer == current_answer) {
+                    {
+                        std::lock_guard<std::mutex> lock(clients_mutex);
+                        for (auto& client : clients)
+                            if (client.fd == client_fd) client.score++;
+                    }
+                    broadcast_common(MSG_CORRECT, player_num, answer);
+                    correct = true;
+                } else {
+                    broadcast_common(MSG_WRONG, player_num, answer);
+                }
+            }
+        } else if (msg_type == MSG_STROKE_SEGMENT) {
+            // 그린 쪽이 TCP로 보내는 sync segment: 송신자 id를 채워 그대로 relay
+            char buf[sizeof(StrokeSegmentHeader) + MAX_STROKE_SEGMENT * sizeof(DrawPoint)];
+            size_t len = 0;
+            if (!recv_strokesegment(client_fd, buf, len)) break;
+            StrokeSegmentHeader* hdr = reinterpret_cast<StrokeSegmentHeader*>(buf);
+            if (!stroke_seq_in_range(*hdr)) continue;   // 연결은 유지하고 이 segment만 버린다
+            hdr->token = 0;
+            hdr->player_id = player_num;
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            log_stroke_frame_locked(buf, len);
+            broadcast_frame_locked(buf, len, client_fd);
+        } else if (msg_type == MSG_UDP_REQUEST) {
+            UdpRequestPacket req;
+            if (transport->recv(client_fd, &req, sizeof(req), MSG_WAITALL) != sizeof(req)) break;
+            offer_udp(client_fd, server_port);
+        } else if (msg_type == MSG_DISCONNECT) { // ★ 추가
+            int dummy;
+            transport->recv(client_fd, &dummy, sizeof(int), 0);
+            std::cout << "[Server] Player(" << nickname << ") disconnect\n";
+            current_Player--;
+            PlayerCntPacket capacity_pkt{};
+            capacity_pkt.type = MSG_PLAYER_CNT;
+            capacity_pkt.currentPlayer_cnt = current_Player;
+            capacity_pkt.maxPlayer = max_Player;
+            broadcast_playerCnt(capacity_pkt);
+            break;   // 아래 정리 경로에서 한 번만 닫는다
+
+        } else {
+            // unknown
+            char buf[256];
+            transport->recv(client_fd, buf, sizeof(buf), 0);
+        }
+        if (correct) break;
+    }
+    session_exit();
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        clients.erase(
+            std::remove_if(clients.begin(), clients.end(),
+                [client_fd](const ClientInfo& c) { return c.fd == client_fd; }),
+            clients.end()
+        );
+    }
+    // 닫은 뒤에는 같은 fd 번호가 새 연결에 재사용될 수 있으므로 등록 해제가 먼저
+    net_backend->remove_connection(client_fd);
+    transport->close(client_fd);
+    broadcast_player_leave(player_num);
+    std::cout << "Client disconnected (" << nickname << ")\n";
+
+    if (clients.empty()) {
+        max_Player = 2; // 모두 나갔을 경우 기본값으로 초기화 
+        std::cout << "[Server] All clients disconnected. max_Player reset to 2.\n";
+
+    }
+}
+
+void handle_client(int client_fd) {
+    // 방 번호는 gateway가 쓰는 정보: gateway가 backend 하나에 방 하나만 배정하므로 읽고 버린다
+    int peek_type = 0;
+    if (transport->recv(client_fd, &peek_type, sizeof(int), MSG_PEEK | MSG_WAITALL) == sizeof(int)
+        && peek_type == MSG_JOIN_ROOM) {
+        JoinRoomPacket room_pkt;
+        transport->recv(client_fd, &room_pkt, sizeof(room_pkt), MSG_WAITALL);
+        transport->recv(client_fd, &peek_type, sizeof(int), MSG_PEEK | MSG_WAITALL);
+    }
+    if (peek_type == MSG_SPECTATE) {
+        handle_spectator(client_fd);
+        return;
+    }
+
+    // 관전자는 위에서 빠졌으므로 여기서부터가 플레이어: 입장 순서와 최초 클라이언트 여부를 정한다
+    bool this_is_first_client;
+    int player_num;
+    {
+        std::lock_guard<std::mutex> lock(is_first_client_mutex);
+        this_is_first_client = is_first_client;
+        is_first_client = false;
+        player_num = player_counter++;
+    }
     std::string nickname = "player" + std::to_string(player_num);
 
-    if (is_first_client) {
+    if (this_is_first_client) {
         // 최초 클라이언트로부터 max_Player 정보 수신
         int msgType = 0;
-        ssize_t n = recv(client_fd, &msgType, sizeof(int), MSG_WAITALL);
+        ssize_t n = transport->recv(client_fd, &msgType, sizeof(int), MSG_WAITALL);
         if (n <= 0 || msgType != MSG_SET_MAX_PLAYER) {
             std::cerr << "Failed to receive maxPlayer info from first client!\n";
-            close(client_fd);
+            close_joining(client_fd, false);
             return;
         }
         int newMaxPlayer = 2;
-        n = recv(client_fd, &newMaxPlayer, sizeof(int), MSG_WAITALL);
+        n = transport->recv(client_fd, &newMaxPlayer, sizeof(int), MSG_WAITALL);
         if (n != sizeof(int)) {
             std::cerr << "Failed to receive maxPlayer value!\n";
-            close(client_fd);
+            close_joining(client_fd, false);
             return;
         }
         max_Player = newMaxPlayer;
@@ -142,23 +657,21 @@ void handle_client(int client_fd, int player_num, bool is_first_client) {
     }else {
         // 모든 후속 클라이언트는 반드시 MSG_SET_MAX_PLAYER + 값 1쌍을 보내야만 한다!
         int msgType = 0;
-        ssize_t n = recv(client_fd, &msgType, sizeof(int), MSG_WAITALL);
+        ssize_t n = transport->recv(client_fd, &msgType, sizeof(int), MSG_WAITALL);
         if (n != sizeof(int) || msgType != MSG_SET_MAX_PLAYER) {
             std::cerr << "[Server] rejected client: did not send MSG_SET_MAX_PLAYER\n";
-            close(client_fd);
+            close_joining(client_fd, false);
             return;
         }
         int requestedMaxPlayer = 0;
-        n = recv(client_fd, &requestedMaxPlayer, sizeof(int), MSG_WAITALL);
+        n = transport->recv(client_fd, &requestedMaxPlayer, sizeof(int), MSG_WAITALL);
         if (n != sizeof(int) || requestedMaxPlayer != max_Player) {
             std::cerr << "[Server] rejected client: requested maxPlayer("
             << requestedMaxPlayer << ") != server max_Player("
             << max_Player << ")\n";
             int reject_type = MSG_REJECTED;
-            send(client_fd, &reject_type, sizeof(reject_type), 0);
-            shutdown(client_fd, SHUT_WR); // write half close (flush)
-            usleep(100000); // 100ms, 충분히 flush할 시간
-            close(client_fd);
+            net_backend->send_one(client_fd, &reject_type, sizeof(reject_type));
+            close_joining(client_fd, true);
             return;
 }
     }
@@ -167,18 +680,18 @@ void handle_client(int client_fd, int player_num, bool is_first_client) {
     if (current_Player >= max_Player) {
         std::cout << "[Server] Out of capacity (current: " << current_Player << ", max: " << max_Player << ")\n";
         int reject_type = MSG_REJECTED;
-        send(client_fd, &reject_type, sizeof(reject_type), 0);
-        shutdown(client_fd, SHUT_WR);
-        usleep(100000); // 100ms
-        close(client_fd);
+        net_backend->send_one(client_fd, &reject_type, sizeof(reject_type));
+        close_joining(client_fd, true);
         return;
     }
 
     {
         std::lock_guard<std::mutex> lock(clients_mutex);
-        clients.push_back({client_fd, nickname});
+        joining_done_locked(client_fd);
+        clients.push_back({client_fd, player_num, nickname});
         current_Player++;
     }
+    net_backend->add_connection(client_fd);
 
     
     PlayerNumPacket player_pkt{};
@@ -194,143 +707,406 @@ void handle_client(int client_fd, int player_num, bool is_first_client) {
     std::cout << "Client connected (" << nickname << ")\n";
     std::cout <<capacity_pkt.currentPlayer_cnt << ")\n";
     broadcast_playerCnt(capacity_pkt);
-    send(client_fd, &player_pkt, sizeof(player_pkt), 0);
+    net_backend->send_one(client_fd, &player_pkt, sizeof(player_pkt));
+    announce_player_join(client_fd, player_num, nickname);
 
     if (current_Player == max_Player) {
-        std::string selected = pick_random_player();
-        if (!selected.empty()) {
+        int selected = pick_random_player();
+        if (selected >= 0) {
             broadcast_selected_player(selected);
-            std::cout << "[Server] Selected player: " << selected << std::endl;
+            std::cout << "[Server] Selected player: player" << selected << std::endl;
         }
     }
 
+    client_session(client_fd, player_num, nickname);
+}
 
-    bool correct = false;
-    while (true) {
-        int msg_type = 0;
-        ssize_t n = recv(client_fd, &msg_type, sizeof(int), MSG_PEEK);
-        if (n <= 0) break;
+// 세션 스레드가 끝난 뒤: 모두 나갔으면 방을 초기 상태로
+static void reset_room_if_empty() {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    if (clients.empty()) {
+        max_Player = 2; // 초기값으로 리셋
+        selected_player = -1;
+        if (!stroke_log.empty()) {
+            // 남은 관전자(relay 포함)의 스냅샷에서도 지난 게임의 획을 지운다
+            DrawPacket clear_pkt{};
+            clear_pkt.type = MSG_CLEAR;
+            send_to_spectators_locked(&clear_pkt, sizeof(clear_pkt));
+        }
+        stroke_log.clear();
+        std::lock_guard<std::mutex> lock2(is_first_client_mutex);
+        is_first_client = true;
+        std::cout << "[Server] All clients disconnected. max_Player and is_first_client reset.\n";
+    }
+}
 
-        if (msg_type == MSG_DRAW) {
-            DrawPacket pkt;
-            if (!recv_drawpacket(client_fd, pkt)) break;
-            broadcast_draw(pkt, client_fd);
-        } else if (msg_type == MSG_ANSWER) {
-            AnswerPacket pkt;
-            if (!recv_answerpacket(client_fd, pkt)) break;
-            std::cout << "[Received answer] " << nickname << ": " << pkt.answer << std::endl;
-            if (pkt.answer == current_answer) {
-                CommonPacket correct_pkt{};
-                correct_pkt.type = MSG_CORRECT;
-                correct_pkt.nickname = nickname;
-                correct_pkt.message = pkt.answer;
-                broadcast_common(correct_pkt);
-                correct = true;
-            } else {
-                CommonPacket wrong_pkt{};
-                wrong_pkt.type = MSG_WRONG;
-                wrong_pkt.nickname = nickname;
-                wrong_pkt.message = pkt.answer;
-                broadcast_common(wrong_pkt);
-            }
-        } else if (msg_type == MSG_DISCONNECT) { // ★ 추가
-            int dummy;
-            recv(client_fd, &dummy, sizeof(int), 0);
-            std::cout << "[Server] Player(" << nickname << ") disconnect\n";
-            current_Player--;
-            PlayerCntPacket capacity_pkt{};
-            capacity_pkt.type = MSG_PLAYER_CNT;
-            capacity_pkt.currentPlayer_cnt = current_Player;
-            capacity_pkt.maxPlayer = max_Player;
-            broadcast_playerCnt(capacity_pkt);
-            close(client_fd);
-	    break;
+// accept된 연결 하나를 처리할 작업. 입장 순서와 최초 클라이언트 여부는 handle_client가
+// 관전자/플레이어를 가른 뒤에 정한다 (관전자가 번호나 방장 자리를 차지하지 않도록)
+static std::function<void()> client_task(int client_fd) {
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        joining_fds.push_back(client_fd);
+    }
+    // 클라이언트 종료 후 방이 비었는지 체크
+    return [client_fd]() {
+        handle_client(client_fd);
+        reset_room_if_empty();
+    };
+}
 
-        } else {
-            // unknown
-            char buf[256];
-            recv(client_fd, buf, sizeof(buf), 0);
+// 입장 처리 없이 메시지 루프부터 다시 시작 (넘겨받은 연결, 또는 인수 실패 후 되돌린 연결)
+static void resume_sessions(const std::vector<int>& fds) {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    for (int fd : fds) {
+        auto it = std::find_if(clients.begin(), clients.end(), [fd](const ClientInfo& c) { return c.fd == fd; });
+        if (it != clients.end()) {
+            std::thread([fd, id = it->player_id, nick = it->nickname]() {
+                client_session(fd, id, nick);
+                reset_room_if_empty();
+            }).detach();
+        } else if (std::find(spectators.begin(), spectators.end(), fd) != spectators.end()) {
+            std::thread([fd]() {
+                spectator_session(fd);
+                reset_room_if_empty();
+            }).detach();
         }
-        if (correct) break;
     }
-    close(client_fd);
+}
+
+// 현재 방 상태를 RoomState로 (clients_mutex 보유 상태)
+static RoomState capture_room_locked(int server_fd) {
+    RoomState st;
+    st.listen_fd = server_fd;
+    st.udp_fd = udp_fd;
+    st.max_player = max_Player;
+    st.current_player = current_Player;
+    st.selected_player = selected_player;
     {
-        std::lock_guard<std::mutex> lock(clients_mutex);
-        clients.erase(
-            std::remove_if(clients.begin(), clients.end(),
-                [client_fd](const ClientInfo& c) { return c.fd == client_fd; }),
-            clients.end()
-        );
+        std::lock_guard<std::mutex> lock(is_first_client_mutex);
+        st.player_counter = player_counter;
+        st.is_first_client = is_first_client;
     }
-    std::cout << "Client disconnected (" << nickname << ")\n";
+    st.answer = current_answer;
+    for (const auto& c : clients)
+        st.players.push_back({c.fd, c.player_id, c.score, c.nickname, c.udp_token, c.udp_ready, c.udp_addr});
+    st.spectators = spectators;
+    st.stroke_log = stroke_log;
+    return st;
+}
 
-    if (clients.empty()) {
-        max_Player = 2; // 모두 나갔을 경우 기본값으로 초기화 
-        std::cout << "[Server] All clients disconnected. max_Player reset to 2.\n";
+static void restore_room(const RoomState& st) {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    max_Player = st.max_player;
+    current_Player = st.current_player;
+    selected_player = st.selected_player;
+    player_counter = st.player_counter;
+    is_first_client = st.is_first_client;
+    current_answer = st.answer;
+    for (const auto& p : st.players) {
+        ClientInfo c{};
+        c.fd = p.fd;
+        c.player_id = p.player_id;
+        c.nickname = p.nickname;
+        c.score = p.score;
+        c.udp_token = p.udp_token;
+        c.udp_ready = p.udp_ready;
+        c.udp_addr = p.udp_addr;
+        clients.push_back(c);
+        net_backend->add_connection(p.fd);
+    }
+    spectators = st.spectators;
+    for (int fd : spectators) net_backend->add_connection(fd);
+    stroke_log = st.stroke_log;
+}
 
+// 새 프로세스가 인수를 요청: 연결 스레드를 메시지 경계에서 멈추고 fd와 방 상태를 넘긴다
+// 성공하면 이 프로세스는 종료하고, 실패하면 멈췄던 연결을 되살려 계속 서비스한다
+static void serve_upgrade_request(int ctl_fd, int server_fd, const std::string& state_path) {
+    int conn = accept4(ctl_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn < 0) return;
+    char req = 0;
+    if (recv(conn, &req, 1, MSG_WAITALL) != 1 || req != 'U') {
+        close(conn);
+        return;
+    }
+    std::cout << "[Server] upgrade requested\n";
+
+    {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        upgrade_parking = true;
+        parked_fds.clear();
+    }
+    uint64_t one = 1;
+    if (write(upgrade_efd, &one, sizeof(one)) != sizeof(one)) perror("eventfd write");
+    bool parked;
+    {
+        std::unique_lock<std::mutex> lock(session_mutex);
+        parked = session_cv.wait_for(lock, std::chrono::milliseconds(UPGRADE_PARK_TIMEOUT_MS),
+                                     [] { return active_sessions == 0; });
+        if (!parked)
+            std::cerr << "[Server] upgrade: " << active_sessions << " session(s) did not park within "
+                      << UPGRADE_PARK_TIMEOUT_MS << "ms, aborting\n";
+    }
+
+    // 메시지 중간에 있는 연결이 남아 있으면 넘기지 않는다 (새 프로세스가 frame 중간부터 읽게 된다)
+    bool ok = false;
+    size_t handed = 0, dropped = 0;
+    if (parked) {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        RoomState st = capture_room_locked(server_fd);
+        handed = st.players.size() + st.spectators.size();
+        ok = hand_off_room(conn, state_path, st);
+        if (ok) {
+            // 입장 처리 중인 연결은 끊는다: 클라이언트가 다시 접속하면 새 프로세스가 받는다
+            for (int fd : joining_fds) shutdown(fd, SHUT_RDWR);
+            dropped = joining_fds.size();
+        }
+    }
+    close(conn);
+    if (ok) {
+        // 연결을 닫지 않고 종료: 새 프로세스가 같은 socket을 이어서 쓴다
+        std::cout << "[Server] handed off " << handed << " connection(s), closed " << dropped
+                  << " still joining, exiting" << std::endl;
+        _exit(0);
+    }
+
+    // 취소: 신호를 먼저 거두고 나서 parking을 끈다. 그 사이에 멈춘 연결도 parked_fds에 들어간다
+    uint64_t v;
+    if (read(upgrade_efd, &v, sizeof(v)) != sizeof(v)) perror("eventfd read");
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        upgrade_parking = false;
+        fds.swap(parked_fds);
     }
+    resume_sessions(fds);
+    std::cout << "[Server] upgrade aborted, resumed " << fds.size() << " parked connection(s)\n";
 }
 
-void run_server(unsigned short port, const std::string& answer_word) {
+static void start_udp_relay(const ServerOptions& opts) {
+    udp_loss = LossSim(opts.udp_loss, 0.0, opts.udp_reorder, 1);
+    std::thread(udp_relay_thread).detach();
+    std::cout << "[Server] UDP stroke channel enabled\n";
+}
+
+void run_server(unsigned short port, const std::string& answer_word, const ServerOptions& opts) {
     current_answer = answer_word;
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0) { perror("socket"); exit(1); }
-    int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-    sockaddr_in server_addr{};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    server_addr.sin_port = htons(25000);
-    if (bind(server_fd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("bind"); exit(1);
-    }
-    if (listen(server_fd, MAX_CLIENTS) < 0) {
-        perror("listen"); exit(1);
-    }
-    std::cout << "[서버] 192.168.10.3:25000에서 대기중... (정답:" << current_answer << ")\n";
-    int player_counter = 1;
-    current_Player = 0;
-    bool is_first_client = true;
-    std::mutex is_first_client_mutex; 
+    // 획 기록이 자라면서 메시지 처리 중에 재할당하지 않도록 (실제로 쓴 page만 메모리를 차지한다)
+    stroke_log.reserve(STROKE_LOG_MAX_BYTES);
+    server_opts = opts;
+    server_port = port;
+    // 끊긴 소켓에 쓰더라도 프로세스가 죽지 않도록 (io_uring WRITE는 MSG_NOSIGNAL을 쓸 수 없다)
+    signal(SIGPIPE, SIG_IGN);
+    net_backend = make_net_backend(opts.io_backend);
+    std::cout << "[Server] io backend: " << net_backend->name() << std::endl;
+    upgrade_efd = eventfd(0, EFD_CLOEXEC);
+    if (upgrade_efd < 0) { perror("eventfd"); exit(1); }
+    transport = std::make_unique<SocketTransport>(upgrade_efd);
+
+    std::string upgrade_path = opts.upgrade_path.empty() ? default_upgrade_path(port) : opts.upgrade_path;
+    std::string state_path = upgrade_path + ".state";
+    int server_fd = -1;
+
+    if (opts.takeover) {
+        // 실행 중인 server_app에서 listen/클라이언트 fd와 방 상태를 넘겨받는다
+        RoomState st;
+        int conn = request_takeover(upgrade_path, state_path, st);
+        if (conn < 0) exit(1);
+        // commit을 받기 전에는 넘겨받은 fd를 등록하거나 읽지 않는다
+        if (!ack_takeover(conn, st)) exit(1);
+        server_fd = st.listen_fd;
+        udp_fd = st.udp_fd;
+        restore_room(st);
+        if (udp_fd >= 0) start_udp_relay(opts);
+
+        std::vector<int> fds;
+        for (const auto& p : st.players) fds.push_back(p.fd);
+        fds.insert(fds.end(), st.spectators.begin(), st.spectators.end());
+        resume_sessions(fds);
+        std::cout << "[Server] took over " << st.players.size() << " player(s), "
+                  << st.spectators.size() << " spectator(s) (정답:" << current_answer << ")\n";
+    } else {
+        server_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (server_fd < 0) { perror("socket"); exit(1); }
+        int opt = 1;
+        setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+        sockaddr_in server_addr{};
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        server_addr.sin_port = htons(port);
+        if (bind(server_fd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            perror("bind"); exit(1);
+        }
+        if (listen(server_fd, MAX_CLIENTS) < 0) {
+            perror("listen"); exit(1);
+        }
+
+        if (opts.udp) {
+            // 같은 포트 번호의 UDP 소켓으로 실시간 획 점을 relay
+            udp_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            if (udp_fd < 0 || bind(udp_fd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+                perror("bind(udp)");
+                if (udp_fd >= 0) close(udp_fd);
+                udp_fd = -1;
+            } else {
+                start_udp_relay(opts);
+            }
+        }
+        std::cout << "[서버] port " << port << "에서 대기중... (정답:" << current_answer << ")\n";
+        player_counter = 1;
+        current_Player = 0;
+        is_first_client = true;
+    }
+
+    if (opts.simplify_tol > 0.0f) std::thread(simplify_flush_thread).detach();
+
+    // 다음 버전의 server_app이 --takeover로 접속할 제어 socket
+    int ctl_fd = listen_upgrade_socket(upgrade_path);
 
     while (true) {
+        pollfd pfds[2] = {{server_fd, POLLIN, 0}, {ctl_fd, POLLIN, 0}};   // ctl_fd < 0이면 poll이 무시
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno != EINTR) perror("poll");
+            continue;
+        }
+        if (pfds[1].revents & POLLIN) {
+            serve_upgrade_request(ctl_fd, server_fd, state_path);
+            continue;
+        }
+        if (!(pfds[0].revents & POLLIN)) continue;
+
         sockaddr_in client_addr{};
         socklen_t client_len = sizeof(client_addr);
         int client_fd = accept(server_fd, (sockaddr*)&client_addr, &client_len);
         if (client_fd < 0) { perror("accept"); continue; }
 
-        // 현재 is_first_client 값 읽어서 전달
-        bool this_is_first_client;
-        {
-            std::lock_guard<std::mutex> lock(is_first_client_mutex);
-            this_is_first_client = is_first_client;
-            if (is_first_client) is_first_client = false;
-        }
+        std::thread(client_task(client_fd)).detach();
+    }
+    close(server_fd);
+}
+
+// 가상 클라이언트 opts.sim_clients개를 한 스레드에서 loopback 연결로 돌린다
+// socket/스레드가 없고 스케줄 순서가 seed로 정해지므로 같은 옵션이면 같은 결과가 나온다
+// make alloc_check 빌드에서는 메시지 처리 중 힙 할당이 있으면 false
+bool run_simulation(const std::string& answer_word, const ServerOptions& opts) {
+    current_answer = answer_word;
+    stroke_log.reserve(STROKE_LOG_MAX_BYTES);
+    server_opts = opts;
+    game_rng.seed(opts.sim_seed);
+    FiberScheduler sched(opts.sim_seed);
+    auto loop = std::make_unique<LoopbackNet>(sched, opts.sim_preempt, opts.sim_seed * 2654435761u);
+    LoopbackNet& net = *loop;
+    transport = std::move(loop);
+    net_backend = std::make_unique<LoopbackBackend>(net);
+    player_counter = 1;
+    current_Player = 0;
+    is_first_client = true;
 
-        // 스레드 생성 시 람다로 감싸서, 클라이언트 종료 후 체크
-        std::thread([&, client_fd, player_num = player_counter++, this_is_first_client]() {
-            handle_client(client_fd, player_num, this_is_first_client);
+    SimConfig cfg;
+    cfg.clients = opts.sim_clients;
+    cfg.drawers = opts.sim_drawers;
+    cfg.batches = opts.sim_batches;
+    SimStats stats;
+    SimLobby lobby;
+    auto accept = [&sched](int fd) { sched.spawn(client_task(fd)); };
+    for (int i = 0; i < cfg.clients; ++i)
+        sched.spawn([&, i]() { sim_client(sched, net, i, cfg, lobby, stats, accept); });
 
-            // 클라이언트가 종료된 후 체크
-            std::lock_guard<std::mutex> lock(clients_mutex);
-            if (clients.empty()) {
-                max_Player = 2; // 초기값으로 리셋
-                std::lock_guard<std::mutex> lock2(is_first_client_mutex);
-                is_first_client = true;
-                std::cout << "[Server] All clients disconnected. max_Player and is_first_client reset.\n";
-            }
-        }).detach();
+    // 연결마다 찍는 서버 로그는 측정을 흐리므로 끈다
+    std::streambuf* out = std::cout.rdbuf(nullptr);
+    std::streambuf* err = std::cerr.rdbuf(nullptr);
+    auto start = std::chrono::steady_clock::now();
+    size_t stuck = sched.run();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout.rdbuf(out);
+    std::cerr.rdbuf(err);
+    std::cout.clear();
+    std::cerr.clear();
 
+    std::cout << "[sim] clients=" << cfg.clients << " drawers=" << cfg.drawers << " batches=" << cfg.batches
+              << " seed=" << opts.sim_seed << " preempt=" << opts.sim_preempt << '\n';
+    std::cout << "[sim] points sent " << stats.points_sent << ", answers " << stats.answers_sent
+              << ", frames delivered " << stats.frames_rx << " (" << stats.bytes_rx << " bytes)\n";
+    std::cout << "[sim] rejected " << stats.rejected << ", bad frames " << stats.bad_frames
+              << ", current_Player at end " << current_Player << ", blocked fibers " << stuck << '\n';
+    std::cout << "[sim] " << secs << " s, " << (uint64_t)(stats.frames_rx / secs) << " frames/s, "
+              << (uint64_t)(net.bytes_sent() / secs / (1024 * 1024)) << " MB/s, "
+              << sched.switches() << " switches, trace " << std::hex << sched.trace_hash() << std::dec << std::endl;
+#ifdef SERVER_ALLOC_COUNT
+    std::cout << "[sim] heap allocations while handling messages: " << message_alloc_count()
+              << " over " << message_count() << " messages" << std::endl;
+    if (opts.sim_preempt > 0.0)
+        std::cout << "[sim] --sim-preempt에서는 다른 fiber의 할당도 섞여 세어진다" << std::endl;
+    if (message_count() == 0 || message_alloc_count() > 0) {
+        std::cout << "[sim] alloc check FAILED" << std::endl;
+        return false;
     }
-    close(server_fd);
+    std::cout << "[sim] alloc check passed" << std::endl;
+#endif
+    return true;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "usage: " << argv[0] << " <answer_word>\n";
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <answer_word> [options]\n";
+        std::cerr << "  --port=N            listen 포트 (기본 " << SERVER_PORT << ")\n";
+        std::cerr << "  --simplify-tol=PX   밀린 수신자에게 보내는 획을 최대 PX 오차로 단순화\n";
+        std::cerr << "  --io=socket|uring   broadcast 송신 backend (기본 socket)\n";
+        std::cerr << "  --udp [--udp-loss=P --udp-reorder=P]  UDP 실시간 획 채널 (손실/순서 바뀜 시뮬레이션)\n";
+        std::cerr << "  --sim=N [--sim-seed=S --sim-drawers=D --sim-batches=B --sim-preempt=P]\n";
+        std::cerr << "                      socket 없이 가상 클라이언트 N개로 결정적 시뮬레이션/벤치마크\n";
+        std::cerr << "  --takeover          실행 중인 server_app의 연결/방 상태를 넘겨받아 무중단 재시작\n";
+        std::cerr << "  --upgrade-sock=PATH 재시작용 제어 socket (기본 /tmp/server_app.<port>.sock)\n";
         return 1;
     }
-    run_server(25000, argv[1]);
+    ServerOptions opts;
+    unsigned short port = SERVER_PORT;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        const std::string simplify = "--simplify-tol=";
+        const std::string io = "--io=";
+        const std::string port_opt = "--port=";
+        const std::string udp_loss_opt = "--udp-loss=";
+        const std::string udp_reorder_opt = "--udp-reorder=";
+        const std::string upgrade_opt = "--upgrade-sock=";
+        const std::string sim_opt = "--sim=";
+        const std::string sim_seed_opt = "--sim-seed=";
+        const std::string sim_drawers_opt = "--sim-drawers=";
+        const std::string sim_batches_opt = "--sim-batches=";
+        const std::string sim_preempt_opt = "--sim-preempt=";
+        if (a.compare(0, port_opt.size(), port_opt) == 0) {
+            port = (unsigned short)std::stoi(a.substr(port_opt.size()));
+        } else if (a.compare(0, simplify.size(), simplify) == 0) {
+            opts.simplify_tol = std::stof(a.substr(simplify.size()));
+        } else if (a.compare(0, io.size(), io) == 0) {
+            opts.io_backend = a.substr(io.size());
+        } else if (a.compare(0, sim_opt.size(), sim_opt) == 0) {
+            opts.sim_clients = std::stoi(a.substr(sim_opt.size()));
+        } else if (a.compare(0, sim_seed_opt.size(), sim_seed_opt) == 0) {
+            opts.sim_seed = (uint32_t)std::stoul(a.substr(sim_seed_opt.size()));
+        } else if (a.compare(0, sim_drawers_opt.size(), sim_drawers_opt) == 0) {
+            opts.sim_drawers = std::stoi(a.substr(sim_drawers_opt.size()));
+        } else if (a.compare(0, sim_batches_opt.size(), sim_batches_opt) == 0) {
+            opts.sim_batches = std::stoi(a.substr(sim_batches_opt.size()));
+        } else if (a.compare(0, sim_preempt_opt.size(), sim_preempt_opt) == 0) {
+            opts.sim_preempt = std::stod(a.substr(sim_preempt_opt.size()));
+        } else if (a == "--takeover") {
+            opts.takeover = true;
+        } else if (a.compare(0, upgrade_opt.size(), upgrade_opt) == 0) {
+            opts.upgrade_path = a.substr(upgrade_opt.size());
+        } else if (a == "--udp") {
+            opts.udp = true;
+        } else if (a.compare(0, udp_loss_opt.size(), udp_loss_opt) == 0) {
+            opts.udp_loss = std::stod(a.substr(udp_loss_opt.size()));
+        } else if (a.compare(0, udp_reorder_opt.size(), udp_reorder_opt) == 0) {
+            opts.udp_reorder = std::stod(a.substr(udp_reorder_opt.size()));
+        } else {
+            std::cerr << "unknown option: " << a << '\n';
+            return 1;
+        }
+    }
+    if (opts.sim_clients > 0) return run_simulation(argv[1], opts) ? 0 : 1;
+    run_server(port, argv[1], opts);
     return 0;
 }
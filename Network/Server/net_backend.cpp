@@ -0,0 +1,24 @@
+#include "net_backend.h"
+#include "uring_backend.h"
+#include <iostream>
+#include <sys/socket.h>
+
+void NetBackend::send_one(int fd, const void* buf, size_t len) {
+    send(fd, buf, len, MSG_NOSIGNAL);
+}
+
+void NetBackend::send_to_all(const int* fds, size_t n, const void* buf, size_t len) {
+    for (size_t i = 0; i < n; ++i)
+        send(fds[i], buf, len, MSG_NOSIGNAL);
+}
+
+std::unique_ptr<NetBackend> make_net_backend(const std::string& kind) {
+    if (kind == "uring") {
+        auto uring = std::make_unique<UringBackend>();
+        if (uring->init()) return uring;
+        std::cerr << "[Server] io_uring unavailable, falling back to socket backend\n";
+    } else if (kind != "socket") {
+        std::cerr << "[Server] unknown io backend '" << kind << "', using socket\n";
+    }
+    return std::make_unique<SocketBackend>();
+}
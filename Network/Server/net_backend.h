@@ -0,0 +1,34 @@
+#ifndef NET_BACKEND_H
+#define NET_BACKEND_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// 서버 송신 경로 추상화. 시작 시 --io=socket|uring 으로 선택한다
+// 수신/accept는 연결 스레드의 blocking recv를 그대로 사용하고,
+// 한 메시지를 여러 연결로 보내는 broadcast fan-out을 backend가 담당한다
+class NetBackend {
+public:
+    virtual ~NetBackend() = default;
+    virtual const char* name() const = 0;
+
+    // 연결이 생기고 사라질 때 호출 (등록 파일 테이블 관리용)
+    virtual void add_connection(int fd) { (void)fd; }
+    virtual void remove_connection(int fd) { (void)fd; }
+
+    virtual void send_one(int fd, const void* buf, size_t len);
+    // 같은 버퍼를 n개 연결에 전송. 반환 시점에 모든 전송이 끝나 있다
+    virtual void send_to_all(const int* fds, size_t n, const void* buf, size_t len);
+};
+
+// 기본 backend: 연결마다 send() 1회
+class SocketBackend : public NetBackend {
+public:
+    const char* name() const override { return "socket"; }
+};
+
+// "socket" | "uring". uring 초기화에 실패하면 socket으로 대체
+std::unique_ptr<NetBackend> make_net_backend(const std::string& kind);
+
+#endif // NET_BACKEND_H
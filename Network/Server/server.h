@@ -1,12 +1,30 @@
 #ifndef SERVER_H
 #define SERVER_H
 
+#include <cstdint>
 #include <string>
 #include "../Common/protocol.h"
 
 int max_Player = 2; // temporary value
 int current_Player = 0;
 
-void run_server(unsigned short port, const std::string& answer_word);
+struct ServerOptions {
+    float simplify_tol = 0.0f;  // 0이면 획 단순화 끔, >0이면 적체된 수신자에게 적용할 최대 tolerance(px)
+    std::string io_backend = "socket";  // "socket" | "uring"
+    bool udp = false;                   // UDP 실시간 획 채널 제안 여부
+    double udp_loss = 0.0;              // 서버 -> 수신자 UDP 손실 시뮬레이션 확률
+    double udp_reorder = 0.0;
+    bool takeover = false;              // 실행 중인 server_app의 연결과 방 상태를 넘겨받아 시작
+    std::string upgrade_path;           // 제어 Unix socket 경로 (비어 있으면 /tmp/server_app.<port>.sock)
+    // --sim: socket 없이 가상 클라이언트로 돌리는 결정적 시뮬레이션
+    int sim_clients = 0;
+    int sim_drawers = 1;
+    int sim_batches = 100;
+    uint32_t sim_seed = 1;
+    double sim_preempt = 0.0;           // recv마다 이 확률로 다른 fiber에게 양보
+};
+
+void run_server(unsigned short port, const std::string& answer_word, const ServerOptions& opts);
+bool run_simulation(const std::string& answer_word, const ServerOptions& opts);
 
 #endif // SERVER_H
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "simulation.h"
+#include "../Common/frame_codec.h"
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// 가상 클라이언트의 수신 쪽: 받은 바이트를 프레임 단위로 잘라 센다
+struct SimReceiver {
+    LoopbackNet& net;
+    int fd;
+    SimStats& stats;
+    std::vector<char> pending;
+    bool joined = false;    // MSG_PLAYER_NUM 또는 MSG_REJECTED를 받음
+    bool eof = false;
+
+    SimReceiver(LoopbackNet& n, int f, SimStats& s) : net(n), fd(f), stats(s) {}
+
+    void parse() {
+        size_t off = 0;
+        while (off < pending.size()) {
+            ssize_t len = frame_length(pending.data() + off, pending.size() - off);
+            if (len < 0) {
+                stats.bad_frames++;
+                pending.clear();
+                return;
+            }
+            if (len == 0) break;
+            int type;
+            std::memcpy(&type, pending.data() + off, sizeof(type));
+            if (type == MSG_PLAYER_NUM) joined = true;
+            if (type == MSG_REJECTED) {
+                joined = true;
+                stats.rejected++;
+            }
+            stats.frames_rx++;
+            off += len;
+        }
+        pending.erase(pending.begin(), pending.begin() + off);
+    }
+
+    // until_eof면 서버가 닫을 때까지 block, 아니면 지금 와 있는 것만
+    void drain(bool until_eof) {
+        char buf[4096];
+        while (!eof) {
+            ssize_t n = net.recv(fd, buf, sizeof(buf), until_eof ? 0 : MSG_DONTWAIT);
+            if (n < 0 && errno == EAGAIN) break;
+            if (n <= 0) {
+                eof = true;
+                break;
+            }
+            pending.insert(pending.end(), buf, buf + n);
+            stats.bytes_rx += n;
+            parse();
+        }
+    }
+};
+
+void send_batch(LoopbackNet& net, int fd, int index, int b, const SimConfig& cfg) {
+    const int points = 8;
+    char buf[sizeof(DrawBatchHeader) + points * sizeof(DrawPoint)];
+    DrawBatchHeader hdr{MSG_DRAW_BATCH, points};
+    std::memcpy(buf, &hdr, sizeof(hdr));
+    DrawPoint* p = reinterpret_cast<DrawPoint*>(buf + sizeof(hdr));
+    for (int k = 0; k < points; ++k) {
+        int step = b * points + k;
+        p[k].x = (index * 37 + step * 3) % CANVAS_WIDTH;
+        p[k].y = (index * 11 + step * 2) % CANVAS_HEIGHT;
+        p[k].color = 1;
+        p[k].thick = 3;
+        bool last = b == cfg.batches - 1 && k == points - 1;
+        p[k].drawStatus = step == 0 ? DRAW_STROKE_START : last ? DRAW_STROKE_END : DRAW_STROKE_CONTINUE;
+        p[k].t_us = step * 2083;
+    }
+    net.send(fd, buf, sizeof(buf));
+}
+
+void send_answer(LoopbackNet& net, int fd, const std::string& answer) {
+    int type = MSG_ANSWER;
+    uint32_t nick_len = 0;
+    uint32_t len = answer.size();
+    net.send(fd, &type, sizeof(type));
+    net.send(fd, &nick_len, sizeof(nick_len));
+    net.send(fd, &len, sizeof(len));
+    net.send(fd, answer.data(), len);
+}
+
+} // namespace
+
+void sim_client(FiberScheduler& sched, LoopbackNet& net, int index, const SimConfig& cfg,
+                SimLobby& lobby, SimStats& stats, const std::function<void(int)>& accept) {
+    if (index != 0) {
+        while (!lobby.host_ready) {
+            lobby.waiting.push_back(sched.current());
+            sched.block();
+        }
+    }
+
+    auto fds = net.connect();
+    accept(fds.first);
+    int fd = fds.second;
+    SimReceiver rx(net, fd, stats);
+
+    int join[2] = { MSG_SET_MAX_PLAYER, cfg.clients };
+    net.send(fd, join, sizeof(join));
+    if (index == 0) {
+        // 방장: 입장이 끝나야 max player가 정해진다
+        while (!rx.joined && !rx.eof) {
+            net.wait_readable(fd);
+            rx.drain(false);
+        }
+        lobby.host_ready = true;
+        for (int f : lobby.waiting) sched.wake(f);
+        lobby.waiting.clear();
+    }
+
+    for (int b = 0; b < cfg.batches && !rx.eof; ++b) {
+        if (index < cfg.drawers) {
+            send_batch(net, fd, index, b, cfg);
+            stats.points_sent += 8;
+        } else if (b == 0) {
+            send_answer(net, fd, "sim-wrong-" + std::to_string(index));
+            stats.answers_sent++;
+        }
+        rx.drain(false);
+        sched.yield();
+    }
+
+    int bye = MSG_DISCONNECT;
+    net.send(fd, &bye, sizeof(bye));
+    rx.drain(true);
+    net.close(fd);
+}
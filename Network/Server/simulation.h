@@ -0,0 +1,35 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "loopback.h"
+
+// server_app --sim=N: 가상 클라이언트 N개가 loopback 연결로 실제 handle_client와 대화한다
+struct SimConfig {
+    int clients = 0;
+    int drawers = 1;        // 앞에서부터 이만큼이 그림을 그리고 나머지는 오답을 보낸다
+    int batches = 100;      // 그리는 쪽이 보내는 MSG_DRAW_BATCH 수 (배치당 8점)
+};
+
+struct SimStats {
+    uint64_t frames_rx = 0;
+    uint64_t bytes_rx = 0;
+    uint64_t bad_frames = 0;
+    uint64_t rejected = 0;
+    uint64_t points_sent = 0;
+    uint64_t answers_sent = 0;
+};
+
+// 방장(0번)이 입장을 끝낼 때까지 나머지 가상 클라이언트를 재운다 (실제로도 방장이 max player를 정한다)
+struct SimLobby {
+    bool host_ready = false;
+    std::vector<int> waiting;
+};
+
+// 가상 클라이언트 하나. accept는 연결을 만든 뒤 서버 쪽 fd로 호출된다
+void sim_client(FiberScheduler& sched, LoopbackNet& net, int index, const SimConfig& cfg,
+                SimLobby& lobby, SimStats& stats, const std::function<void(int)>& accept);
+
+#endif // SIMULATION_H
@@ -0,0 +1,76 @@
+#include "stroke_simplify.h"
+#include <cmath>
+#include <ctime>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+
+static float distance_to_segment(const DrawPoint& a, const DrawPoint& b, const DrawPoint& p) {
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float px = p.x - a.x, py = p.y - a.y;
+    float len2 = dx * dx + dy * dy;
+    if (len2 == 0.0f) return std::sqrt(px * px + py * py);
+    float t = (px * dx + py * dy) / len2;
+    if (t < 0.0f) t = 0.0f;
+    else if (t > 1.0f) t = 1.0f;
+    float ex = px - t * dx, ey = py - t * dy;
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+int StrokeSimplifier::push(const DrawPoint& p, float tolerance, uint64_t now_us, DrawPoint* out) {
+    int n = 0;
+    if (p.drawStatus == DRAW_STROKE_START || !in_stroke_ || tolerance <= 0.0f
+        || p.color != anchor_.color || p.thick != anchor_.thick) {
+        if (has_candidate_) out[n++] = candidate_;
+        has_candidate_ = false;
+        out[n++] = p;
+        anchor_ = p;
+        in_stroke_ = p.drawStatus != DRAW_STROKE_END;
+        return n;
+    }
+
+    if (p.drawStatus == DRAW_STROKE_END) {
+        if (has_candidate_) out[n++] = candidate_;
+        out[n++] = p;
+        has_candidate_ = false;
+        in_stroke_ = false;
+        return n;
+    }
+
+    if (has_candidate_ && distance_to_segment(anchor_, p, candidate_) > tolerance) {
+        out[n++] = candidate_;
+        anchor_ = candidate_;
+        has_candidate_ = false;
+    }
+    if (!has_candidate_) held_since_us_ = now_us;
+    candidate_ = p;
+    has_candidate_ = true;
+    return n;
+}
+
+int StrokeSimplifier::flush_stale(uint64_t now_us, DrawPoint* out) {
+    if (!has_candidate_) return 0;
+    if (now_us - held_since_us_ < SIMPLIFY_MAX_HOLD_US) return 0;
+    out[0] = candidate_;
+    anchor_ = candidate_;
+    has_candidate_ = false;
+    return 1;
+}
+
+float simplify_tolerance_for_backlog(int backlog_bytes, float max_tolerance) {
+    if (backlog_bytes <= SIMPLIFY_BACKLOG_LOW) return 0.0f;
+    if (backlog_bytes >= SIMPLIFY_BACKLOG_HIGH) return max_tolerance;
+    return max_tolerance * (backlog_bytes - SIMPLIFY_BACKLOG_LOW)
+           / (float)(SIMPLIFY_BACKLOG_HIGH - SIMPLIFY_BACKLOG_LOW);
+}
+
+uint64_t monotonic_us() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+int socket_send_backlog(int fd) {
+    int bytes = 0;
+    if (ioctl(fd, SIOCOUTQ, &bytes) < 0) return 0;
+    return bytes;
+}
@@ -0,0 +1,44 @@
+#ifndef STROKE_SIMPLIFY_H
+#define STROKE_SIMPLIFY_H
+
+#include <cstdint>
+#include "../Common/protocol.h"
+
+// 수신자별 송신 큐 적체(SIOCOUTQ) 기준
+#define SIMPLIFY_BACKLOG_LOW  (4 * 1024)    // 이하면 원본 그대로
+#define SIMPLIFY_BACKLOG_HIGH (64 * 1024)   // 이상이면 최대 tolerance
+// 단순화로 점을 붙잡아 둘 수 있는 최대 시간 (획 끝이 늦게 보이지 않도록). 서버 시계 기준
+#define SIMPLIFY_MAX_HOLD_US  50000
+// 펜이 멈춰 배치가 오지 않을 때도 붙잡은 점을 내보내는 서버 타이머 주기
+#define SIMPLIFY_FLUSH_INTERVAL_US (SIMPLIFY_MAX_HOLD_US / 2)
+
+// 스트리밍 거리 기반 단순화 (Reumann-Witkam 변형)
+// 마지막으로 보낸 점(anchor)과 새 점을 잇는 선분에서 보류 중인 점(candidate)이
+// tolerance 이상 벗어날 때만 candidate를 내보낸다. 획 시작/끝은 항상 보존된다.
+class StrokeSimplifier {
+public:
+    // p를 처리하고 내보낼 점을 out에 쓴다. 반환값은 쓴 개수 (0~2). now_us는 monotonic_us()
+    int push(const DrawPoint& p, float tolerance, uint64_t now_us, DrawPoint* out);
+    // 배치 끝과 서버 타이머에서 호출: SIMPLIFY_MAX_HOLD_US 넘게 붙잡고 있던 candidate를 내보낸다
+    // (송신측 t_us는 펜이 멈추면 더 오지 않으므로 서버 시계로 잰다)
+    int flush_stale(uint64_t now_us, DrawPoint* out);
+    void reset() { in_stroke_ = false; has_candidate_ = false; }
+
+private:
+    bool in_stroke_ = false;
+    bool has_candidate_ = false;
+    DrawPoint anchor_{};
+    DrawPoint candidate_{};
+    uint64_t held_since_us_ = 0;   // 아직 안 보낸 점을 붙잡기 시작한 서버 시각
+};
+
+// 송신 큐 적체량에 따라 0 ~ max_tolerance 사이의 tolerance를 돌려준다
+float simplify_tolerance_for_backlog(int backlog_bytes, float max_tolerance);
+
+// 소켓 송신 큐에 남아있는 바이트 수 (실패 시 0)
+int socket_send_backlog(int fd);
+
+// 서버 CLOCK_MONOTONIC (us)
+uint64_t monotonic_us();
+
+#endif // STROKE_SIMPLIFY_H
@@ -0,0 +1,26 @@
+#include "transport.h"
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+
+ssize_t SocketTransport::recv(int fd, void* buf, size_t len, int flags) {
+    return ::recv(fd, buf, len, flags);
+}
+
+bool SocketTransport::wait_readable(int fd) {
+    pollfd pfds[2] = {{fd, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    while (poll(pfds, 2, -1) < 0) {
+        if (errno != EINTR) return true;
+    }
+    return !(pfds[1].revents & POLLIN);
+}
+
+void SocketTransport::close_after_send(int fd) {
+    shutdown(fd, SHUT_WR); // write half close (flush)
+    usleep(100000); // 100ms, 충분히 flush할 시간
+    ::close(fd);
+}
+
+void SocketTransport::close(int fd) {
+    ::close(fd);
+}
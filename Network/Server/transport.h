@@ -0,0 +1,36 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+// 연결 스레드의 수신 경로 추상화 (송신은 NetBackend)
+// 게임 로직은 fd 번호와 recv(2) 의미만 알고, 실제 socket인지 메모리 안의 가상 연결인지는 모른다
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    // recv(2)와 같은 의미. flags는 MSG_PEEK, MSG_WAITALL, MSG_DONTWAIT 조합
+    virtual ssize_t recv(int fd, void* buf, size_t len, int flags) = 0;
+    // 다음 메시지가 올 때까지 대기. 재시작 등으로 깨워졌으면 false
+    virtual bool wait_readable(int fd) = 0;
+    // 거절 메시지처럼 마지막으로 보낸 것을 상대가 읽을 수 있게 한 뒤 닫는다
+    virtual void close_after_send(int fd) = 0;
+    virtual void close(int fd) = 0;
+};
+
+// 실제 TCP socket. wake_fd(eventfd)가 readable이 되면 wait_readable이 false를 돌려준다
+class SocketTransport : public Transport {
+public:
+    explicit SocketTransport(int wake_fd) : wake_fd_(wake_fd) {}
+
+    ssize_t recv(int fd, void* buf, size_t len, int flags) override;
+    bool wait_readable(int fd) override;
+    void close_after_send(int fd) override;
+    void close(int fd) override;
+
+private:
+    int wake_fd_;
+};
+
+#endif // TRANSPORT_H
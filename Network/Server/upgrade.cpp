@@ -0,0 +1,286 @@
+#include "upgrade.h"
+#include "../Common/protocol.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define UPGRADE_FDS_PER_MSG 200   // SCM_MAX_FD(253)보다 작게 나눠 보낸다
+
+// 상태 파일 layout: header, players(고정 부분 + 닉네임), answer, stroke_log
+struct StateHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t max_player;
+    int32_t current_player;
+    int32_t player_counter;
+    int32_t selected_player;
+    int32_t is_first_client;
+    int32_t has_udp;
+    uint32_t player_count;
+    uint32_t spectator_count;
+    uint32_t answer_len;
+    uint32_t stroke_log_len;
+};
+
+struct StatePlayer {
+    int32_t player_id;
+    int32_t score;
+    uint32_t udp_token;
+    int32_t udp_ready;
+    sockaddr_in udp_addr;
+    uint32_t nickname_len;
+};
+
+std::string default_upgrade_path(unsigned short port) {
+    return "/tmp/server_app." + std::to_string(port) + ".sock";
+}
+
+// ---------------- 상태 파일 (mmap) ----------------
+static bool save_state(const std::string& path, const RoomState& st) {
+    size_t size = sizeof(StateHeader) + st.answer.size() + st.stroke_log.size();
+    for (const auto& p : st.players) size += sizeof(StatePlayer) + p.nickname.size();
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) { perror(path.c_str()); return false; }
+    if (ftruncate(fd, size) < 0) { perror("ftruncate"); close(fd); return false; }
+    char* base = static_cast<char*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    close(fd);
+    if (base == MAP_FAILED) { perror("mmap"); return false; }
+
+    char* p = base;
+    auto put = [&p](const void* src, size_t len) { std::memcpy(p, src, len); p += len; };
+    StateHeader hdr{UPGRADE_MAGIC, UPGRADE_VERSION, st.max_player, st.current_player, st.player_counter,
+                    st.selected_player, st.is_first_client, st.udp_fd >= 0,
+                    (uint32_t)st.players.size(), (uint32_t)st.spectators.size(),
+                    (uint32_t)st.answer.size(), (uint32_t)st.stroke_log.size()};
+    put(&hdr, sizeof(hdr));
+    for (const auto& pl : st.players) {
+        StatePlayer sp{pl.player_id, pl.score, pl.udp_token, pl.udp_ready, pl.udp_addr, (uint32_t)pl.nickname.size()};
+        put(&sp, sizeof(sp));
+        put(pl.nickname.data(), pl.nickname.size());
+    }
+    put(st.answer.data(), st.answer.size());
+    put(st.stroke_log.data(), st.stroke_log.size());
+
+    msync(base, size, MS_SYNC);
+    munmap(base, size);
+    return true;
+}
+
+static bool load_state(const std::string& path, RoomState& st, size_t& fd_count) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { perror(path.c_str()); return false; }
+    struct stat sb;
+    if (fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(StateHeader)) { close(fd); return false; }
+    size_t size = sb.st_size;
+    const char* base = static_cast<const char*>(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+    close(fd);
+    if (base == MAP_FAILED) { perror("mmap"); return false; }
+
+    const char* p = base;
+    const char* end = base + size;
+    auto get = [&p, end](void* dst, size_t len) {
+        if ((size_t)(end - p) < len) return false;
+        std::memcpy(dst, p, len);
+        p += len;
+        return true;
+    };
+    bool ok = false;
+    StateHeader hdr;
+    if (get(&hdr, sizeof(hdr)) && hdr.magic == UPGRADE_MAGIC && hdr.version == UPGRADE_VERSION) {
+        st.max_player = hdr.max_player;
+        st.current_player = hdr.current_player;
+        st.player_counter = hdr.player_counter;
+        st.selected_player = hdr.selected_player;
+        st.is_first_client = hdr.is_first_client != 0;
+        st.udp_fd = hdr.has_udp ? 0 : -1;   // 실제 fd는 recv 후 채운다
+        st.players.clear();
+        ok = true;
+        for (uint32_t i = 0; ok && i < hdr.player_count; ++i) {
+            StatePlayer sp;
+            SavedPlayer pl{};
+            ok = get(&sp, sizeof(sp)) && sp.nickname_len <= MAX_MESSAGE_LEN;
+            if (!ok) break;
+            pl.player_id = sp.player_id;
+            pl.score = sp.score;
+            pl.udp_token = sp.udp_token;
+            pl.udp_ready = sp.udp_ready != 0;
+            pl.udp_addr = sp.udp_addr;
+            pl.nickname.resize(sp.nickname_len);
+            ok = get(&pl.nickname[0], sp.nickname_len);
+            st.players.push_back(pl);
+        }
+        st.answer.resize(hdr.answer_len);
+        st.stroke_log.resize(hdr.stroke_log_len);
+        ok = ok && get(&st.answer[0], hdr.answer_len) && get(st.stroke_log.data(), hdr.stroke_log_len);
+        st.spectators.assign(hdr.spectator_count, -1);
+        fd_count = 1 + (hdr.has_udp ? 1 : 0) + hdr.player_count + hdr.spectator_count;
+    }
+    munmap(const_cast<char*>(base), size);
+    if (!ok) std::cerr << "[upgrade] 상태 파일이 손상되었습니다: " << path << '\n';
+    return ok;
+}
+
+// ---------------- fd 전달 (SCM_RIGHTS) ----------------
+static bool send_fds(int sock, const std::vector<int>& fds) {
+    uint32_t count = fds.size();
+    if (send(sock, &count, sizeof(count), MSG_NOSIGNAL) != sizeof(count)) return false;
+    for (size_t off = 0; off < fds.size(); off += UPGRADE_FDS_PER_MSG) {
+        size_t n = std::min<size_t>(UPGRADE_FDS_PER_MSG, fds.size() - off);
+        char byte = 'F';
+        iovec iov{&byte, 1};
+        std::vector<char> ctrl(CMSG_SPACE(n * sizeof(int)));
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl.data();
+        msg.msg_controllen = ctrl.size();
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(n * sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), fds.data() + off, n * sizeof(int));
+        if (sendmsg(sock, &msg, MSG_NOSIGNAL) != 1) { perror("sendmsg(SCM_RIGHTS)"); return false; }
+    }
+    return true;
+}
+
+static bool recv_fds(int sock, std::vector<int>& fds) {
+    uint32_t count = 0;
+    if (recv(sock, &count, sizeof(count), MSG_WAITALL) != sizeof(count)) return false;
+    fds.clear();
+    while (fds.size() < count) {
+        size_t n = std::min<size_t>(UPGRADE_FDS_PER_MSG, count - fds.size());
+        char byte;
+        iovec iov{&byte, 1};
+        std::vector<char> ctrl(CMSG_SPACE(n * sizeof(int)));
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl.data();
+        msg.msg_controllen = ctrl.size();
+        if (recvmsg(sock, &msg, 0) != 1) { perror("recvmsg(SCM_RIGHTS)"); return false; }
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg == nullptr || cmsg->cmsg_type != SCM_RIGHTS || (msg.msg_flags & MSG_CTRUNC)) return false;
+        size_t got = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const int* p = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+        fds.insert(fds.end(), p, p + got);
+    }
+    return true;
+}
+
+// ---------------- 제어 socket ----------------
+static bool make_unix_addr(const std::string& path, sockaddr_un& addr) {
+    addr = sockaddr_un{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[upgrade] socket 경로가 너무 깁니다: " << path << '\n';
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+int listen_upgrade_socket(const std::string& path) {
+    sockaddr_un addr;
+    if (!make_unix_addr(path, addr)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) { perror("socket(unix)"); return -1; }
+    unlink(path.c_str());   // 이전 프로세스가 남긴 경로 (인수 후에는 새 프로세스가 주인)
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1) < 0) {
+        perror(("bind " + path).c_str());
+        close(fd);
+        return -1;
+    }
+    chmod(path.c_str(), 0600);
+    return fd;
+}
+
+bool hand_off_room(int conn, const std::string& state_path, const RoomState& st) {
+    if (!save_state(state_path, st)) return false;
+
+    std::vector<int> fds;
+    fds.push_back(st.listen_fd);
+    if (st.udp_fd >= 0) fds.push_back(st.udp_fd);
+    for (const auto& p : st.players) fds.push_back(p.fd);
+    fds.insert(fds.end(), st.spectators.begin(), st.spectators.end());
+    if (!send_fds(conn, fds)) return false;
+
+    // 새 프로세스가 fd를 다 받을 때까지 기다린다. 응답이 없으면 abort를 알리고 인수 실패
+    pollfd pfd{conn, POLLIN, 0};
+    char ack = 0;
+    if (poll(&pfd, 1, UPGRADE_ACK_TIMEOUT_MS) <= 0 || recv(conn, &ack, 1, 0) != 1 || ack != 'K') {
+        std::cerr << "[upgrade] 새 프로세스가 인수를 완료하지 못했습니다\n";
+        char abort_msg = 'A';
+        send(conn, &abort_msg, 1, MSG_NOSIGNAL);
+        return false;
+    }
+    // commit이 전달되지 않으면 새 프로세스는 fd를 쓰지 않고 끝나므로 계속 서비스해도 된다
+    char commit = 'C';
+    if (send(conn, &commit, 1, MSG_NOSIGNAL) != 1) {
+        perror("[upgrade] commit");
+        return false;
+    }
+    return true;
+}
+
+int request_takeover(const std::string& path, const std::string& state_path, RoomState& st) {
+    sockaddr_un addr;
+    if (!make_unix_addr(path, addr)) return -1;
+    int conn = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn < 0) { perror("socket(unix)"); return -1; }
+    if (connect(conn, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror(("connect " + path).c_str());
+        close(conn);
+        return -1;
+    }
+    char req = 'U';
+    std::vector<int> fds;
+    size_t fd_count = 0;
+    if (send(conn, &req, 1, MSG_NOSIGNAL) != 1 || !recv_fds(conn, fds)
+        || !load_state(state_path, st, fd_count) || fds.size() != fd_count) {
+        std::cerr << "[upgrade] 기존 프로세스로부터 상태를 받지 못했습니다\n";
+        for (int fd : fds) close(fd);
+        close(conn);
+        return -1;
+    }
+
+    size_t i = 0;
+    st.listen_fd = fds[i++];
+    if (st.udp_fd >= 0) st.udp_fd = fds[i++];
+    for (auto& p : st.players) p.fd = fds[i++];
+    for (auto& s : st.spectators) s = fds[i++];
+    return conn;
+}
+
+static void close_room_fds(const RoomState& st) {
+    close(st.listen_fd);
+    if (st.udp_fd >= 0) close(st.udp_fd);
+    for (const auto& p : st.players) close(p.fd);
+    for (int fd : st.spectators) close(fd);
+}
+
+bool ack_takeover(int conn, const RoomState& st) {
+    char ack = 'K';
+    char reply = 0;
+    pollfd pfd{conn, POLLIN, 0};
+    bool committed = send(conn, &ack, 1, MSG_NOSIGNAL) == 1
+                     && poll(&pfd, 1, UPGRADE_COMMIT_TIMEOUT_MS) > 0
+                     && recv(conn, &reply, 1, 0) == 1 && reply == 'C';
+    close(conn);
+    if (!committed) {
+        // 기존 프로세스가 계속 서비스한다: 같은 socket을 둘이 읽지 않도록 받은 fd는 건드리지 않고 닫는다
+        std::cerr << "[upgrade] 기존 프로세스가 인수를 확정하지 않았습니다 ("
+                  << (reply == 'A' ? "abort" : "응답 없음") << ")\n";
+        close_room_fds(st);
+    }
+    return committed;
+}
@@ -0,0 +1,61 @@
+#ifndef UPGRADE_H
+#define UPGRADE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+// 무중단 재시작: 실행 중인 server_app이 Unix socket으로 listen/클라이언트 fd를 SCM_RIGHTS로 넘기고,
+// 방 상태는 mmap한 파일에 기록한다. 새 프로세스는 ./server_app <word> --takeover 로 시작
+#define UPGRADE_MAGIC 0x55505247u   // "GRPU"
+#define UPGRADE_VERSION 1
+#define UPGRADE_PARK_TIMEOUT_MS 2000    // 연결 스레드가 메시지 경계에서 멈출 때까지 기다리는 시간
+#define UPGRADE_ACK_TIMEOUT_MS 5000     // 새 프로세스가 인수 준비를 알릴 때까지 (넘으면 기존 프로세스가 계속 서비스)
+#define UPGRADE_COMMIT_TIMEOUT_MS 2000  // ack 후 기존 프로세스의 commit/abort 응답까지 (넘으면 새 프로세스가 포기)
+
+// 제어 socket 위의 1바이트 메시지
+// 새 -> 기존: 'U' 인수 요청, 'K' fd/상태를 받았음
+// 기존 -> 새: 'C' commit (기존 프로세스는 종료), 'A' abort (기존 프로세스가 계속 서비스)
+// 새 프로세스는 'C'를 받기 전에는 넘겨받은 fd로 읽거나 쓰지 않는다
+
+struct SavedPlayer {
+    int fd;
+    int player_id;
+    int score;
+    std::string nickname;
+    uint32_t udp_token;
+    bool udp_ready;
+    sockaddr_in udp_addr;
+};
+
+// 프로세스 간에 넘기는 방 상태. fd 값은 보내는 쪽/받는 쪽 각자의 번호
+struct RoomState {
+    int listen_fd = -1;
+    int udp_fd = -1;
+    int max_player = 2;
+    int current_player = 0;
+    int player_counter = 1;
+    int selected_player = -1;
+    bool is_first_client = true;
+    std::string answer;
+    std::vector<SavedPlayer> players;
+    std::vector<int> spectators;
+    std::vector<char> stroke_log;
+};
+
+// 기본 경로: /tmp/server_app.<port>.sock, 상태 파일은 <sock>.state
+std::string default_upgrade_path(unsigned short port);
+
+// 기존 프로세스 쪽: 제어 socket을 열고, 접속이 오면 hand_off_room으로 넘긴다
+int listen_upgrade_socket(const std::string& path);
+// 상태 파일 기록 + fd 전송 후 새 프로세스의 ack를 기다리고 commit을 보낸다
+// true면 commit이 전달됨 (종료해야 한다), false면 인수 실패 (계속 서비스)
+bool hand_off_room(int conn, const std::string& state_path, const RoomState& st);
+
+// 새 프로세스 쪽: 기존 프로세스에 접속해 fd와 상태를 받는다. 그 다음 ack_takeover
+int request_takeover(const std::string& path, const std::string& state_path, RoomState& st);
+// ack를 보내고 commit을 기다린다. abort/시간 초과/전송 실패면 넘겨받은 fd를 모두 닫고 false
+bool ack_takeover(int conn, const RoomState& st);
+
+#endif // UPGRADE_H
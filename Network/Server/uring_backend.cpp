@@ -0,0 +1,227 @@
+#include "uring_backend.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+static int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+UringBackend::~UringBackend() {
+    if (sqes_) munmap(sqes_, sqes_map_size_);
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_map_size_);
+    if (sq_ptr_) munmap(sq_ptr_, sq_map_size_);
+    if (ring_fd_ >= 0) close(ring_fd_);
+    free(send_buf_);
+}
+
+bool UringBackend::init() {
+    io_uring_params p{};
+    ring_fd_ = sys_io_uring_setup(URING_ENTRIES, &p);
+    if (ring_fd_ < 0) { perror("io_uring_setup"); return false; }
+
+    sq_map_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_map_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        if (cq_map_size_ > sq_map_size_) sq_map_size_ = cq_map_size_;
+        cq_map_size_ = sq_map_size_;
+    }
+    sq_ptr_ = mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) { sq_ptr_ = nullptr; perror("mmap(sq)"); return false; }
+    if (single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    } else {
+        cq_ptr_ = mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) { cq_ptr_ = nullptr; perror("mmap(cq)"); return false; }
+    }
+    sqes_map_size_ = p.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = (io_uring_sqe*)mmap(nullptr, sqes_map_size_, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) { sqes_ = nullptr; perror("mmap(sqes)"); return false; }
+
+    char* sq = (char*)sq_ptr_;
+    char* cq = (char*)cq_ptr_;
+    sq_head_ = (unsigned*)(sq + p.sq_off.head);
+    sq_tail_ = (unsigned*)(sq + p.sq_off.tail);
+    sq_mask_ = (unsigned*)(sq + p.sq_off.ring_mask);
+    sq_array_ = (unsigned*)(sq + p.sq_off.array);
+    cq_head_ = (unsigned*)(cq + p.cq_off.head);
+    cq_tail_ = (unsigned*)(cq + p.cq_off.tail);
+    cq_mask_ = (unsigned*)(cq + p.cq_off.ring_mask);
+    cqes_ = (io_uring_cqe*)(cq + p.cq_off.cqes);
+
+    // 등록 버퍼: broadcast 프레임을 여기로 복사해서 WRITE_FIXED로 보낸다
+    if (posix_memalign((void**)&send_buf_, 4096, URING_SEND_BUF_SIZE) != 0) {
+        send_buf_ = nullptr;
+        return false;
+    }
+    iovec iov{send_buf_, URING_SEND_BUF_SIZE};
+    if (sys_io_uring_register(ring_fd_, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+        perror("IORING_REGISTER_BUFFERS");
+        return false;
+    }
+
+    // 등록 파일: 빈 slot(-1)으로 만들어 두고 연결마다 갱신
+    static int empty_files[URING_FIXED_FILES];
+    for (int i = 0; i < URING_FIXED_FILES; ++i) empty_files[i] = -1;
+    fixed_files_ = sys_io_uring_register(ring_fd_, IORING_REGISTER_FILES,
+                                         empty_files, URING_FIXED_FILES) == 0;
+    if (!fixed_files_) perror("IORING_REGISTER_FILES (plain fds will be used)");
+    return true;
+}
+
+void UringBackend::update_file_slot(int fd, int value) {
+    if (!fixed_files_ || fd < 0 || fd >= URING_FIXED_FILES) return;
+    io_uring_files_update up{};
+    up.offset = fd;
+    up.fds = (uint64_t)(uintptr_t)&value;
+    if (sys_io_uring_register(ring_fd_, IORING_REGISTER_FILES_UPDATE, &up, 1) < 0) {
+        perror("IORING_REGISTER_FILES_UPDATE");
+        registered_[fd] = false;
+        return;
+    }
+    registered_[fd] = value >= 0;
+}
+
+void UringBackend::add_connection(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    update_file_slot(fd, fd);
+}
+
+void UringBackend::remove_connection(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    update_file_slot(fd, -1);
+}
+
+io_uring_sqe* UringBackend::get_sqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    unsigned tail = *sq_tail_;
+    if (tail - head >= URING_ENTRIES) return nullptr;
+    unsigned idx = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes_[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[idx] = idx;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+int UringBackend::submit_and_wait(unsigned to_submit, unsigned wait_nr) {
+    int ret;
+    do {
+        ret = sys_io_uring_enter(ring_fd_, to_submit, wait_nr, IORING_ENTER_GETEVENTS);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+// 쓰기 실패한 연결은 끊어서 수신 스레드가 정리하게 한다 (frame 일부만 간 stream은 더 쓸 수 없다)
+void UringBackend::fail_connection(int fd, int err) {
+    fprintf(stderr, "[uring] write to fd %d failed: %s\n", fd, err ? strerror(err) : "connection closed");
+    shutdown(fd, SHUT_RDWR);
+}
+
+// io_uring으로 못 보낸 나머지는 blocking send()로 끝까지 보낸다
+void UringBackend::send_rest(const Pending& p, size_t len) {
+    size_t sent = p.sent;
+    while (sent < len) {
+        ssize_t n = send(p.fd, send_buf_ + sent, len - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            fail_connection(p.fd, n < 0 ? errno : 0);
+            return;
+        }
+        sent += n;
+    }
+}
+
+void UringBackend::queue_write(unsigned slot, size_t len) {
+    const Pending& p = inflight_[slot];
+    io_uring_sqe* sqe = get_sqe();   // 이전 제출을 모두 거둔 뒤라 비어 있다
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->addr = (uint64_t)(uintptr_t)(send_buf_ + p.sent);
+    sqe->len = len - p.sent;
+    sqe->buf_index = 0;
+    sqe->off = (uint64_t)-1;   // 소켓: 파일 위치 없음
+    sqe->fd = p.fd;
+    if (p.fd >= 0 && p.fd < URING_FIXED_FILES && registered_[p.fd])
+        sqe->flags |= IOSQE_FIXED_FILE;   // slot 번호 == fd 번호
+    sqe->user_data = slot;
+}
+
+void UringBackend::reap(unsigned count, size_t len) {
+    unsigned head = *cq_head_;
+    while (count > 0) {
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            // 실패해도 빠져나가지 않는다: 진행 중인 write가 끝나기 전에는 send_buf_를 놓을 수 없다
+            if (submit_and_wait(0, 1) < 0) perror("io_uring_enter(wait)");
+            continue;
+        }
+        const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+        Pending& p = inflight_[cqe.user_data];
+        if (cqe.res > 0) {
+            p.sent += cqe.res;
+            if (p.sent < len) retry_[nretry_++] = p;   // 짧은 write: 남은 바이트를 다시 제출
+        } else if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+            retry_[nretry_++] = p;
+        } else {
+            fail_connection(p.fd, -cqe.res);
+        }
+        head++;
+        count--;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+void UringBackend::send_one(int fd, const void* buf, size_t len) {
+    send_to_all(&fd, 1, buf, len);
+}
+
+void UringBackend::send_to_all(const int* fds, size_t n, const void* buf, size_t len) {
+    if (n == 0) return;
+    if (len > URING_SEND_BUF_SIZE) {
+        NetBackend::send_to_all(fds, n, buf, len);
+        return;
+    }
+    // send_buf_는 모든 연결에 끝까지 쓸 때까지 mutex_ 안에서만 쓰이고, 그 전에는 덮어쓰지 않는다
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::memcpy(send_buf_, buf, len);
+
+    size_t done = 0;
+    nretry_ = 0;
+    while (done < n || nretry_ > 0) {
+        // 짧게 끝난 연결을 먼저, 남는 자리에 새 연결을 넣는다
+        unsigned queued = 0;
+        for (unsigned i = 0; i < nretry_; ++i) inflight_[queued++] = retry_[i];
+        nretry_ = 0;
+        while (done < n && queued < URING_ENTRIES) inflight_[queued++] = Pending{fds[done++], 0};
+        for (unsigned i = 0; i < queued; ++i) queue_write(i, len);
+
+        // 완료 대기는 reap에서: 일부만 제출됐을 때 queued개를 기다리며 멈추지 않도록
+        int submitted = submit_and_wait(queued, 0);
+        if (submitted < 0) {
+            perror("io_uring_enter");
+            submitted = 0;
+        }
+        if ((unsigned)submitted < queued) {
+            // 제출되지 않은 SQE는 ring에서 거두고 blocking send로 마저 보낸다
+            __atomic_store_n(sq_tail_, __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+            for (unsigned i = submitted; i < queued; ++i) send_rest(inflight_[i], len);
+        }
+        reap(submitted, len);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef URING_BACKEND_H
+#define URING_BACKEND_H
+
+#include <cstdint>
+#include <mutex>
+#include <linux/io_uring.h>
+#include "net_backend.h"
+
+#define URING_ENTRIES 64
+#define URING_FIXED_FILES 1024          // fd 번호를 그대로 등록 파일 slot으로 사용
+#define URING_SEND_BUF_SIZE (64 * 1024) // 등록 버퍼 (broadcast 프레임을 복사해서 사용)
+
+// io_uring broadcast backend (liburing 없이 raw syscall 사용)
+// 한 번의 broadcast를 연결 수만큼의 WRITE_FIXED SQE로 만들어
+// io_uring_enter 1회로 제출/완료 대기한다. 소켓은 등록 파일, 버퍼는 등록 버퍼를 쓴다
+// 짧게 끝난 write는 남은 바이트를 다시 제출하고, 모든 연결에 끝까지 쓴 뒤에야 반환한다
+class UringBackend : public NetBackend {
+public:
+    ~UringBackend() override;
+    bool init();
+    const char* name() const override { return "uring"; }
+
+    void add_connection(int fd) override;
+    void remove_connection(int fd) override;
+    void send_one(int fd, const void* buf, size_t len) override;
+    void send_to_all(const int* fds, size_t n, const void* buf, size_t len) override;
+
+private:
+    // 연결 하나에 대한 진행 상황. sqe의 user_data는 inflight_의 index
+    struct Pending {
+        int fd;
+        size_t sent;
+    };
+
+    void update_file_slot(int fd, int value);
+    io_uring_sqe* get_sqe();
+    int submit_and_wait(unsigned to_submit, unsigned wait_nr);
+    void queue_write(unsigned slot, size_t len);
+    void reap(unsigned count, size_t len);
+    void send_rest(const Pending& p, size_t len);
+    void fail_connection(int fd, int err);
+
+    std::mutex mutex_;
+    int ring_fd_ = -1;
+    bool fixed_files_ = false;
+    // add_connection으로 실제 등록된 slot. 등록 전(입장 거절 등)인 fd는 plain fd로 보낸다
+    bool registered_[URING_FIXED_FILES] = {};
+
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    size_t sq_map_size_ = 0;
+    size_t cq_map_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_map_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    char* send_buf_ = nullptr;
+
+    Pending inflight_[URING_ENTRIES];
+    Pending retry_[URING_ENTRIES];   // 짧게 끝나서 다음 제출에 다시 넣을 것
+    unsigned nretry_ = 0;
+};
+
+#endif // URING_BACKEND_H
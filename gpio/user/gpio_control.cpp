@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <cstdio>
+#include <cstdlib>
 #include <thread>
 #include <chrono>
 
@@ -26,6 +27,12 @@ void handle_device_control_request(requestType requestType)
             // LED OFF
             ioctl(fd, MY_IOCTL_CMD_LED_OFF);
             break;
+        case LED_ON:
+            ioctl(fd, MY_IOCTL_CMD_LED_ON);
+            break;
+        case LED_OFF:
+            ioctl(fd, MY_IOCTL_CMD_LED_OFF);
+            break;
         case LED_WRONG:
             ioctl(fd, MY_IOCTL_CMD_LED_BLINK);
             break;
@@ -36,4 +43,47 @@ void handle_device_control_request(requestType requestType)
             break; 
     }
     close(fd);
+}
+
+int gpio_open_device(const char* path)
+{
+    if (path == nullptr) path = getenv("MYDEV_PATH");
+    if (path == nullptr) path = GPIO_DEV_PATH;
+    // O_RDWR: ioctl 용도 + stub(FIFO)로 대체했을 때 writer가 없어도 HUP 되지 않도록
+    int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) perror(path);
+    return fd;
+}
+
+bool gpio_read_button(int fd, int& btn_idx)
+{
+    int value = -1;
+    ssize_t n = read(fd, &value, sizeof(value));
+    if (n != sizeof(value)) return false;
+    btn_idx = value;
+    return true;
+}
+
+// sleep 없이 한 번의 ioctl만 수행 (LED off 타이밍은 호출 측 타이머가 담당)
+// stub 장치는 ioctl을 지원하지 않으므로 실패는 무시한다
+void gpio_device_request(int fd, requestType requestType)
+{
+    if (fd < 0) return;
+    switch(requestType){
+        case LED_CORRECT:
+        case LED_ON:
+            ioctl(fd, MY_IOCTL_CMD_LED_ON);
+            break;
+        case LED_OFF:
+            ioctl(fd, MY_IOCTL_CMD_LED_OFF);
+            break;
+        case LED_WRONG:
+            ioctl(fd, MY_IOCTL_CMD_LED_BLINK);
+            break;
+        case BTN_CLEAR:
+            ioctl(fd, MY_IOCTL_CMD_BTN_CLEAR);
+            break;
+        default:
+            break;
+    }
 }
\ No newline at end of file
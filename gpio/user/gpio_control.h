@@ -6,9 +6,28 @@
 enum requestType {
     LED_CORRECT,
     LED_WRONG,
-    BTN_CLEAR
+    BTN_CLEAR,
+    LED_ON,
+    LED_OFF
+};
+
+// device_read()가 돌려주는 버튼 인덱스 (커널 gpio_keys[] 순서와 동일)
+enum buttonEvent {
+    BTN_EVT_CLEAR_PEN = 0,
+    BTN_EVT_CLEAR = 1,
+    BTN_EVT_COLOR_CHANGE = 2,
+    BTN_EVT_INC_PEN_SIZE = 3,
+    BTN_EVT_DEC_PEN_SIZE = 4
 };
 
 void handle_device_control_request(requestType requestType);
 
-#endif // GPIO_CONTROL_H
\ No newline at end of file
+// 이벤트 루프용 API
+// path가 nullptr이면 MYDEV_PATH 환경변수, 없으면 /dev/mydev 사용
+// 주의: 실제 드라이버는 read가 O_NONBLOCK을 무시하고 (EPOLLIN 후 한 번만 읽을 것),
+//       LED_WRONG(LED_BLINK)은 ioctl 안에서 약 800ms busy-wait 한다
+int gpio_open_device(const char* path = nullptr);
+bool gpio_read_button(int fd, int& btn_idx);
+void gpio_device_request(int fd, requestType requestType);
+
+#endif // GPIO_CONTROL_H